@@ -0,0 +1,438 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Offline decoder of alarm captures.
+ *
+ * The capture is memory-mapped and the synchronization, demodulation and CRC check run
+ * directly on the mapped pages, without a flowgraph. The capture is split into chunks
+ * overlapping by a whole frame, decoded in parallel; the frames found in two chunks are
+ * merged. Each decoded alarm is printed with the input sample index of its first payload
+ * symbol:
+ *
+ *   alarm_decode -r 1000000 -s 8,9 -f sc16 capture.raw
+ *   alarm_decode capture.sigmf-meta
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <volk/volk.h>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "frame_sync_engine.h"
+#include "symbol_demod.h"
+#include "chirp_table.h"
+#include "crc16.h"
+#include "work_stealing_pool.h"
+
+using namespace gr::CounterClockwiseAlarms;
+using gr::lora_sdr::mod;
+
+namespace {
+
+    const int chunk_samples = 1 << 22;  ///< input samples given to the engines per call
+    const int max_symbols = 256;        ///< payload symbols output by an engine per call
+    const int64_t max_chunk_samples = 1 << 25; ///< largest chunk decoded by one thread
+    const double max_frame_symbols = 8 + 2 + 2.25 + 3; ///< preamble, sync words, downchirps and the ID with its CRC
+
+    struct options
+    {
+        double samp_rate = 0;
+        uint32_t bw = 125000;
+        std::vector<uint8_t> sfs;
+        std::vector<uint16_t> sync_words = {0x12};
+        sample_format format = SAMPLE_FC32;
+        float full_scale = 0;
+        float squelch_db = 0;
+        int max_frames = 4;
+        bool all = false;
+        int threads = std::max(1u, std::thread::hardware_concurrency());
+        std::string path;
+    };
+
+    /**
+     *  \brief  A decoded frame
+     */
+    struct alarm_frame
+    {
+        int64_t sample_index;   ///< input index of the first payload symbol
+        uint8_t sf;             ///< spreading factor
+        uint8_t id;             ///< alarm ID
+        bool crc_ok;            ///< the CRC check passed
+    };
+
+    /**
+     *  \brief  Frame synchronization, demodulation and CRC check of one spreading factor
+     */
+    struct decoder
+    {
+        uint8_t sf;
+        uint32_t nbins;
+        frame_sync_engine sync;
+        std::unique_ptr<symbol_demodulator> demod;
+        const chirp_table *chirps;
+        std::vector<gr_complex> symbols;
+        std::vector<gr_complex> downchirp;
+        std::vector<frame_start> frames;
+        int64_t base;       ///< input index of the first sample still needed by sync
+        int symb_cnt;       ///< number of symbols of the current frame received
+        int64_t frame_index;///< input index of the current frame
+        uint8_t id;         ///< ID of the current frame
+        crc16 crc;
+
+        decoder(const options &opt, uint8_t sf)
+          : sf(sf), nbins(1u << sf), sync(opt.samp_rate, opt.bw, sf, opt.sync_words),
+            demod(symbol_demodulator::make(sf)), chirps(&chirp_table::get(sf)),
+            symbols(max_symbols * nbins), downchirp(nbins), base(0), symb_cnt(0), frame_index(0), id(0)
+        {
+            //the ID followed by its CRC, as AlarmTransmitter sends it
+            sync.set_symb_numb(3);
+            sync.set_input_format(opt.format, opt.full_scale);
+            sync.set_squelch_threshold(opt.squelch_db);
+            sync.set_max_frames(opt.max_frames);
+        }
+    };
+
+    void usage(const char *name)
+    {
+        fprintf(stderr,
+                "usage: %s [options] capture\n"
+                "  -r, --samp-rate HZ     sampling rate of the capture (from the SigMF metadata if any)\n"
+                "  -b, --bandwidth HZ     LoRa bandwidth, 125000 by default\n"
+                "  -s, --sf LIST          comma separated spreading factors, 8 by default\n"
+                "  -w, --sync-word WORD   network identifier, 0x12 by default\n"
+                "  -f, --format FMT       fc32, sc16 or sc8 samples (from the SigMF metadata if any)\n"
+                "  -S, --full-scale VAL   integer value of an amplitude of 1.0 for sc16 and sc8\n"
+                "  -q, --squelch DB       skip windows less than DB above the noise floor, 0 disables\n"
+                "  -m, --max-frames N     frames synchronized at the same time, per spreading factor\n"
+                "  -j, --threads N        decoding threads, one per core by default\n"
+                "  -a, --all              also print the frames failing the CRC check\n"
+                "A capture path ending in .sigmf-meta or .sigmf-data is read as a SigMF recording.\n",
+                name);
+    }
+
+    bool parse_format(const std::string &name, sample_format &format)
+    {
+        if (name == "fc32" || name == "cf32_le")
+            format = SAMPLE_FC32;
+        else if (name == "sc16" || name == "ci16_le")
+            format = SAMPLE_SC16;
+        else if (name == "sc8" || name == "ci8")
+            format = SAMPLE_SC8;
+        else
+            return false;
+        return true;
+    }
+
+    /**
+     *  \brief  Return the value of a top level key of a SigMF metadata file, quotes stripped
+     */
+    std::string sigmf_value(const std::string &meta, const std::string &key)
+    {
+        size_t pos = meta.find("\"" + key + "\"");
+        if (pos == std::string::npos)
+            return "";
+        pos = meta.find(':', pos + key.size() + 2);
+        if (pos == std::string::npos)
+            return "";
+        pos = meta.find_first_not_of(" \t\r\n\"", pos + 1);
+        size_t end = meta.find_first_of(",}\"\r\n", pos);
+        return pos == std::string::npos ? "" : meta.substr(pos, end - pos);
+    }
+
+    /**
+     *  \brief  Take the data path, the format and the sampling rate from a SigMF recording
+     */
+    bool read_sigmf(options &opt)
+    {
+        const std::string meta_ext = ".sigmf-meta", data_ext = ".sigmf-data";
+        std::string base;
+        if (opt.path.size() > meta_ext.size() && opt.path.compare(opt.path.size() - meta_ext.size(), meta_ext.size(), meta_ext) == 0)
+            base = opt.path.substr(0, opt.path.size() - meta_ext.size());
+        else if (opt.path.size() > data_ext.size() && opt.path.compare(opt.path.size() - data_ext.size(), data_ext.size(), data_ext) == 0)
+            base = opt.path.substr(0, opt.path.size() - data_ext.size());
+        else
+            return true;
+
+        std::ifstream file(base + meta_ext);
+        if (!file) {
+            fprintf(stderr, "cannot open %s\n", (base + meta_ext).c_str());
+            return false;
+        }
+        std::stringstream meta;
+        meta << file.rdbuf();
+        opt.path = base + data_ext;
+
+        std::string datatype = sigmf_value(meta.str(), "core:datatype");
+        if (!parse_format(datatype, opt.format)) {
+            fprintf(stderr, "unsupported SigMF datatype '%s'\n", datatype.c_str());
+            return false;
+        }
+        std::string rate = sigmf_value(meta.str(), "core:sample_rate");
+        if (!opt.samp_rate && !rate.empty())
+            opt.samp_rate = atof(rate.c_str());
+        return true;
+    }
+
+    bool parse_options(int argc, char **argv, options &opt)
+    {
+        static const struct option long_options[] = {
+            {"samp-rate", required_argument, 0, 'r'},
+            {"bandwidth", required_argument, 0, 'b'},
+            {"sf", required_argument, 0, 's'},
+            {"sync-word", required_argument, 0, 'w'},
+            {"format", required_argument, 0, 'f'},
+            {"full-scale", required_argument, 0, 'S'},
+            {"squelch", required_argument, 0, 'q'},
+            {"max-frames", required_argument, 0, 'm'},
+            {"threads", required_argument, 0, 'j'},
+            {"all", no_argument, 0, 'a'},
+            {"help", no_argument, 0, 'h'},
+            {0, 0, 0, 0}};
+        bool format_given = false;
+        int c;
+        while ((c = getopt_long(argc, argv, "r:b:s:w:f:S:q:m:j:ah", long_options, 0)) != -1) {
+            switch (c) {
+            case 'r': opt.samp_rate = atof(optarg); break;
+            case 'b': opt.bw = strtoul(optarg, 0, 0); break;
+            case 's': {
+                std::stringstream list(optarg);
+                std::string sf;
+                while (std::getline(list, sf, ','))
+                    opt.sfs.push_back(atoi(sf.c_str()));
+                break;
+            }
+            case 'w': opt.sync_words = {(uint16_t)strtoul(optarg, 0, 0)}; break;
+            case 'f':
+                if (!parse_format(optarg, opt.format)) {
+                    fprintf(stderr, "unknown sample format '%s'\n", optarg);
+                    return false;
+                }
+                format_given = true;
+                break;
+            case 'S': opt.full_scale = atof(optarg); break;
+            case 'q': opt.squelch_db = atof(optarg); break;
+            case 'm': opt.max_frames = atoi(optarg); break;
+            case 'j': opt.threads = std::max(1, atoi(optarg)); break;
+            case 'a': opt.all = true; break;
+            default: return false;
+            }
+        }
+        if (optind != argc - 1)
+            return false;
+        opt.path = argv[optind];
+
+        sample_format format = opt.format;
+        if (!read_sigmf(opt))
+            return false;
+        //the command line wins over the metadata
+        if (format_given)
+            opt.format = format;
+        if (opt.sfs.empty())
+            opt.sfs.push_back(8);
+        for (size_t i = 0; i < opt.sfs.size(); i++) {
+            //each symbol carries a whole byte of the CRC, SF7 symbols only have 7 bits
+            if (opt.sfs[i] < 8 || opt.sfs[i] > 12) {
+                fprintf(stderr, "spreading factors range from 8 to 12\n");
+                return false;
+            }
+        }
+        if (opt.samp_rate < opt.bw) {
+            fprintf(stderr, "the sampling rate must be given and at least the bandwidth\n");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     *  \brief  Demodulate the payload symbols output by the engine and collect the frames
+     *
+     *  \param  offset
+     *          Input index of the first sample given to the engine
+     */
+    void decode_symbols(decoder &dec, int nsymbols, int64_t offset, std::vector<alarm_frame> &alarms)
+    {
+        size_t frame = 0;
+        for (int i = 0; i < nsymbols; i++) {
+            if (frame < dec.frames.size() && dec.frames[frame].out_index == i) {
+                //the downchirp taking CFOint into account, as AlarmReceiver does
+                dec.chirps->upchirp(&dec.downchirp[0], mod(dec.frames[frame].cfo_int, dec.nbins));
+                volk_32fc_conjugate_32fc(&dec.downchirp[0], &dec.downchirp[0], dec.nbins);
+                dec.frame_index = offset + dec.frames[frame].sample_index;
+                dec.symb_cnt = 0;
+                dec.crc.reset();
+                frame++;
+            }
+            demod_result res;
+            dec.demod->demod(&dec.symbols[i * dec.nbins], &dec.downchirp[0], res);
+            uint8_t value = res.bin;
+            if (dec.symb_cnt == 0)
+                dec.id = value;
+            dec.crc.update(value);
+            if (++dec.symb_cnt == 3) {
+                alarm_frame a;
+                a.sample_index = dec.frame_index;
+                a.sf = dec.sf;
+                a.id = dec.id;
+                a.crc_ok = dec.crc.value() == 0;
+                alarms.push_back(a);
+            }
+        }
+    }
+
+    /**
+     *  \brief  Decode the samples [begin, end) of the capture with every spreading factor
+     */
+    void decode_chunk(const options &opt, const uint8_t *data, int64_t begin, int64_t end, std::vector<alarm_frame> &alarms)
+    {
+        size_t item_size = sample_size(opt.format);
+        std::vector<std::unique_ptr<decoder> > decoders;
+        for (size_t i = 0; i < opt.sfs.size(); i++)
+            decoders.emplace_back(new decoder(opt, opt.sfs[i]));
+
+        for (size_t i = 0; i < decoders.size(); i++) {
+            decoder &dec = *decoders[i];
+            //the engine counts its input from 0
+            const uint8_t *in = data + begin * item_size;
+            int64_t nsamples = end - begin;
+            while (true) {
+                int ninput = std::min<int64_t>(chunk_samples, nsamples - dec.base);
+                if (ninput < dec.sync.window_len())
+                    break;
+                int consumed;
+                dec.frames.clear();
+                int nsymbols = dec.sync.work(in + dec.base * item_size, ninput, &dec.symbols[0], max_symbols, consumed, dec.frames);
+                decode_symbols(dec, nsymbols, begin, alarms);
+                dec.base += consumed;
+                if (!consumed && !nsymbols)
+                    break;
+            }
+        }
+    }
+
+    bool operator<(const alarm_frame &a, const alarm_frame &b)
+    {
+        return a.sf != b.sf ? a.sf < b.sf : a.sample_index < b.sample_index;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    options opt;
+    if (!parse_options(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int fd = open(opt.path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "cannot open %s: %s\n", opt.path.c_str(), strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        fprintf(stderr, "cannot read %s\n", opt.path.c_str());
+        close(fd);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const uint8_t *data = (const uint8_t *)mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "cannot map %s: %s\n", opt.path.c_str(), strerror(errno));
+        return 1;
+    }
+    //every chunk is read once, front to back
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    size_t item_size = sample_size(opt.format);
+    int64_t nsamples = size / item_size;
+
+    //chunks overlap by a whole frame of the largest spreading factor, with the symbol window
+    //the detector may start it in, so that every frame lies entirely in at least one chunk
+    uint8_t max_sf = *std::max_element(opt.sfs.begin(), opt.sfs.end());
+    double symbol_samples = (1u << max_sf) * opt.samp_rate / opt.bw;
+    int64_t overlap = (int64_t)std::ceil((max_frame_symbols + 2) * symbol_samples);
+    //several chunks per thread, for the work stealing to even out the load
+    int64_t chunk_len = std::max<int64_t>(8 * overlap, std::min<int64_t>(max_chunk_samples, nsamples / (8 * opt.threads) + 1));
+    size_t nchunks = (nsamples + chunk_len - 1) / chunk_len;
+
+    std::vector<std::vector<alarm_frame> > chunk_alarms(nchunks);
+    size_t page = sysconf(_SC_PAGESIZE);
+    work_stealing_pool pool(opt.threads);
+    pool.run(nchunks, [&](size_t c) {
+        int64_t begin = c * chunk_len;
+        int64_t end = std::min(nsamples, begin + chunk_len + overlap);
+        decode_chunk(opt, data, begin, end, chunk_alarms[c]);
+        //drop the pages of the chunk, days of capture don't stay resident; the mapping is read
+        //only, a neighbour still reading the overlap gets them back from the page cache
+        size_t first = (begin * item_size) / page * page;
+        size_t last = (end * item_size) / page * page;
+        if (last > first)
+            madvise((void *)(data + first), last - first, MADV_DONTNEED);
+    });
+    munmap((void *)data, size);
+
+    //merge the chunks, a frame in the overlap of two chunks is found by both
+    std::vector<alarm_frame> alarms;
+    for (size_t c = 0; c < nchunks; c++)
+        alarms.insert(alarms.end(), chunk_alarms[c].begin(), chunk_alarms[c].end());
+    std::sort(alarms.begin(), alarms.end());
+    std::vector<alarm_frame> merged;
+    for (size_t i = 0; i < alarms.size(); i++) {
+        alarm_frame &last = merged.empty() ? alarms[i] : merged.back();
+        double tolerance = 0.5 * (1u << alarms[i].sf) * opt.samp_rate / opt.bw;
+        if (!merged.empty() && last.sf == alarms[i].sf && alarms[i].sample_index - last.sample_index < tolerance) {
+            //a copy failing the CRC may come from a truncated preamble, its ID is not to be kept
+            if (!last.crc_ok && alarms[i].crc_ok)
+                last = alarms[i];
+        }
+        else
+            merged.push_back(alarms[i]);
+    }
+    std::stable_sort(merged.begin(), merged.end(), [](const alarm_frame &a, const alarm_frame &b) { return a.sample_index < b.sample_index; });
+
+    long valid = 0;
+    for (size_t i = 0; i < merged.size(); i++) {
+        const alarm_frame &a = merged[i];
+        valid += a.crc_ok;
+        if (a.crc_ok || opt.all)
+            printf("%lld %.6f sf%d id=%d crc=%s\n", (long long)a.sample_index, a.sample_index / opt.samp_rate,
+                   a.sf, a.id, a.crc_ok ? "ok" : "bad");
+    }
+    fprintf(stderr, "%ld valid frames in %.1f s of capture, %zu chunks on %d threads\n", valid, nsamples / opt.samp_rate,
+            nchunks, opt.threads);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_WORK_STEALING_POOL_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_WORK_STEALING_POOL_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Runs a fixed set of independent tasks on several threads.
+     *
+     *  Each worker starts with a contiguous range of the tasks, so that neighbouring tasks,
+     *  reading neighbouring data, run on the same thread. A worker runs its own tasks from the
+     *  front and, once it has none left, steals from the back of the other workers, so a
+     *  worker stuck on slow tasks is relieved by the others.
+     */
+    class work_stealing_pool
+    {
+     public:
+      /**
+       *  \param  nthreads
+       *          The number of worker threads, at least 1
+       */
+      explicit work_stealing_pool(int nthreads) : m_nthreads(nthreads < 1 ? 1 : nthreads) {}
+
+      /**
+       *  \brief  Call task(i) for every i in [0, ntasks) and return once all are done
+       */
+      void run(size_t ntasks, const std::function<void(size_t)> &task)
+      {
+          std::vector<std::unique_ptr<worker> > workers;
+          for (int w = 0; w < m_nthreads; w++) {
+              workers.emplace_back(new worker);
+              for (size_t i = ntasks * w / m_nthreads; i < ntasks * (w + 1) / m_nthreads; i++)
+                  workers[w]->tasks.push_back(i);
+          }
+
+          std::vector<std::thread> threads;
+          for (int w = 1; w < m_nthreads; w++)
+              threads.emplace_back([&, w]() { work(workers, w, task); });
+          work(workers, 0, task);
+          for (size_t t = 0; t < threads.size(); t++)
+              threads[t].join();
+      }
+
+     private:
+      struct worker
+      {
+          std::mutex mutex;
+          std::deque<size_t> tasks;
+      };
+
+      static bool pop_front(worker &w, size_t &task)
+      {
+          std::lock_guard<std::mutex> lock(w.mutex);
+          if (w.tasks.empty())
+              return false;
+          task = w.tasks.front();
+          w.tasks.pop_front();
+          return true;
+      }
+
+      static bool pop_back(worker &w, size_t &task)
+      {
+          std::lock_guard<std::mutex> lock(w.mutex);
+          if (w.tasks.empty())
+              return false;
+          task = w.tasks.back();
+          w.tasks.pop_back();
+          return true;
+      }
+
+      static void work(std::vector<std::unique_ptr<worker> > &workers, size_t self,
+                       const std::function<void(size_t)> &task)
+      {
+          size_t i;
+          while (true) {
+              bool found = pop_front(*workers[self], i);
+              //no task is ever added, so every queue found empty means all are taken
+              for (size_t k = 1; !found && k < workers.size(); k++)
+                  found = pop_back(*workers[(self + k) % workers.size()], i);
+              if (!found)
+                  return;
+              task(i);
+          }
+      }
+
+      int m_nthreads;
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_WORK_STEALING_POOL_H */
@@ -0,0 +1,322 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmarks of the chirp generation, demodulation, synchronization and CRC kernels.
+ *
+ * One iteration of the chirp and demodulation kernels processes one symbol, so their time
+ * column is the time per symbol; one iteration of the estimators processes the preamble
+ * of a frame. The samples/s and symbols/s counters give the throughput of all of them. The chirp kernels are swept over
+ * SF7 to SF12 and os_factor 1, 2, 4 and 8; the demodulators and the estimators run on the
+ * decimated signal, one sample per chip, and are swept over the spreading factor only.
+ * Run with --benchmark_format=json or --benchmark_out=<file> for machine readable results.
+ */
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <volk/volk.h>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "chirp_nco.h"
+#include "chirp_table.h"
+#include "crc16.h"
+#include "fft_plan_cache.h"
+#include "frame_sync_engine.h"
+#include "polyphase_decimator.h"
+#include "symbol_demod.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Access to the private CFO and STO estimators of frame_sync_engine
+     */
+    struct frame_sync_engine_bench
+    {
+        static void estimate_CFO(frame_sync_engine &sync, const gr_complex *preamble) { sync.estimate_CFO(preamble); }
+        static void estimate_STO(frame_sync_engine &sync) { sync.estimate_STO(); }
+        static int preamble_symbols(const frame_sync_engine &sync) { return sync.up_symb_to_use; }
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+using namespace gr::CounterClockwiseAlarms;
+
+namespace {
+
+    const uint32_t bw = 125000;
+
+    void set_counters(benchmark::State &state, int64_t samples_per_symbol)
+    {
+        state.counters["samples/s"] = benchmark::Counter(double(state.iterations()) * samples_per_symbol, benchmark::Counter::kIsRate);
+        state.counters["symbols/s"] = benchmark::Counter(double(state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    /**
+     *  \brief  Symbols of random values and their reference downchirp, at one sample per chip
+     */
+    struct symbols
+    {
+        static const int count = 64;
+        uint32_t nbins;
+        std::vector<gr_complex> samples;
+        std::vector<gr_complex> downchirp;
+
+        explicit symbols(uint8_t sf) : nbins(1u << sf), samples(count * nbins), downchirp(nbins)
+        {
+            std::vector<gr_complex> upchirp(nbins);
+            gr::lora_sdr::build_ref_chirps(&upchirp[0], &downchirp[0], sf);
+            std::mt19937 gen(sf);
+            std::normal_distribution<float> noise(0, 0.1);
+            for (int s = 0; s < count; s++) {
+                gr::lora_sdr::build_upchirp(&samples[s * nbins], gen() % nbins, sf);
+                for (uint32_t n = 0; n < nbins; n++)
+                    samples[s * nbins + n] += gr_complex(noise(gen), noise(gen));
+            }
+        }
+    };
+
+    void sweep_sf(benchmark::internal::Benchmark *b)
+    {
+        b->ArgName("sf")->DenseRange(7, 12);
+    }
+
+    void sweep_sf_os(benchmark::internal::Benchmark *b)
+    {
+        b->ArgNames({"sf", "os"});
+        for (int sf = 7; sf <= 12; sf++)
+            for (int os = 1; os <= 8; os *= 2)
+                b->Args({sf, os});
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // Chirp generation
+    ////////////////////////////////////////////////////////////////////////
+
+    void BM_build_upchirp(benchmark::State &state)
+    {
+        uint8_t sf = state.range(0);
+        uint8_t os = state.range(1);
+        uint32_t n = (1u << sf) * os;
+        std::vector<gr_complex> chirp(n);
+        uint32_t id = 0;
+        for (auto _ : state) {
+            gr::lora_sdr::build_upchirp(&chirp[0], id, sf, os);
+            benchmark::DoNotOptimize(chirp.data());
+            id = (id + 37) & ((1u << sf) - 1);
+        }
+        set_counters(state, n);
+    }
+    BENCHMARK(BM_build_upchirp)->Apply(sweep_sf_os);
+
+    void BM_build_ref_chirps(benchmark::State &state)
+    {
+        uint8_t sf = state.range(0);
+        uint8_t os = state.range(1);
+        uint32_t n = (1u << sf) * os;
+        std::vector<gr_complex> upchirp(n), downchirp(n);
+        for (auto _ : state) {
+            gr::lora_sdr::build_ref_chirps(&upchirp[0], &downchirp[0], sf, os);
+            benchmark::DoNotOptimize(upchirp.data());
+            benchmark::DoNotOptimize(downchirp.data());
+        }
+        set_counters(state, n);
+    }
+    BENCHMARK(BM_build_ref_chirps)->Apply(sweep_sf_os);
+
+    void BM_chirp_table_upchirp(benchmark::State &state)
+    {
+        uint8_t sf = state.range(0);
+        uint8_t os = state.range(1);
+        const chirp_table &table = chirp_table::get(sf, os);
+        std::vector<gr_complex> chirp(table.samples_per_symbol());
+        uint32_t id = 0;
+        for (auto _ : state) {
+            table.upchirp(&chirp[0], id);
+            benchmark::DoNotOptimize(chirp.data());
+            id = (id + 37) & ((1u << sf) - 1);
+        }
+        set_counters(state, table.samples_per_symbol());
+    }
+    BENCHMARK(BM_chirp_table_upchirp)->Apply(sweep_sf_os);
+
+    void BM_chirp_nco_upchirp(benchmark::State &state)
+    {
+        uint8_t sf = state.range(0);
+        uint32_t os = state.range(1);
+        chirp_nco nco(sf, os * bw, bw);
+        std::vector<gr_complex> chirp(nco.max_samples());
+        uint32_t id = 0;
+        for (auto _ : state) {
+            nco.upchirp(&chirp[0], id);
+            benchmark::DoNotOptimize(chirp.data());
+            id = (id + 37) & ((1u << sf) - 1);
+        }
+        set_counters(state, nco.max_samples());
+    }
+    BENCHMARK(BM_chirp_nco_upchirp)->Apply(sweep_sf_os);
+
+    ////////////////////////////////////////////////////////////////////////
+    // Decimation and demodulation
+    ////////////////////////////////////////////////////////////////////////
+
+    void BM_polyphase_decimate(benchmark::State &state)
+    {
+        uint8_t sf = state.range(0);
+        uint32_t os = state.range(1);
+        uint32_t nbins = 1u << sf;
+        polyphase_decimator decimator(os * bw, bw);
+        std::vector<gr_complex> in(decimator.input_needed(nbins)), out(nbins);
+        std::mt19937 gen(sf);
+        std::normal_distribution<float> noise(0, 1);
+        for (size_t i = 0; i < in.size(); i++)
+            in[i] = gr_complex(noise(gen), noise(gen));
+        for (auto _ : state) {
+            decimator.decimate(&in[0], &out[0], nbins, 0.25f, 0);
+            benchmark::DoNotOptimize(out.data());
+        }
+        set_counters(state, nbins * os);
+    }
+    BENCHMARK(BM_polyphase_decimate)->Apply(sweep_sf_os);
+
+    // the generic get_symbol_val, on a shared FFT plan
+    void BM_demod_symbol(benchmark::State &state)
+    {
+        uint8_t sf = state.range(0);
+        symbols sym(sf);
+        kiss_fft_cfg cfg = fft_plan_cache::instance().get(sym.nbins);
+        std::vector<kiss_fft_cpx> fft_in(sym.nbins), fft_out(sym.nbins);
+        demod_result res;
+        int s = 0;
+        for (auto _ : state) {
+            demod_symbol(&sym.samples[s * sym.nbins], &sym.downchirp[0], sym.nbins, cfg, &fft_in[0], &fft_out[0], res);
+            benchmark::DoNotOptimize(res);
+            s = (s + 1) % symbols::count;
+        }
+        set_counters(state, sym.nbins);
+    }
+    BENCHMARK(BM_demod_symbol)->Apply(sweep_sf);
+
+    // the get_symbol_val of the blocks, compiled for each spreading factor
+    void BM_symbol_demodulator(benchmark::State &state)
+    {
+        uint8_t sf = state.range(0);
+        symbols sym(sf);
+        std::unique_ptr<symbol_demodulator> demod = symbol_demodulator::make(sf);
+        demod_result res;
+        int s = 0;
+        for (auto _ : state) {
+            demod->demod(&sym.samples[s * sym.nbins], &sym.downchirp[0], res);
+            benchmark::DoNotOptimize(res);
+            s = (s + 1) % symbols::count;
+        }
+        set_counters(state, sym.nbins);
+    }
+    BENCHMARK(BM_symbol_demodulator)->Apply(sweep_sf);
+
+    ////////////////////////////////////////////////////////////////////////
+    // Synchronization, once per frame: one iteration is the whole preamble
+    ////////////////////////////////////////////////////////////////////////
+
+    /**
+     *  \brief  Preamble upchirps with a fractional CFO, and an engine to estimate it
+     */
+    struct preamble
+    {
+        uint32_t nbins;
+        frame_sync_engine sync;
+        int nsymbols;
+        std::vector<gr_complex> samples;
+
+        explicit preamble(uint8_t sf)
+          : nbins(1u << sf), sync(bw, bw, sf, std::vector<uint16_t>(1, 0x12)),
+            nsymbols(frame_sync_engine_bench::preamble_symbols(sync)), samples(nsymbols * nbins)
+        {
+            for (int s = 0; s < nsymbols; s++)
+                gr::lora_sdr::build_upchirp(&samples[s * nbins], 0, sf);
+            gr_complex phase(1, 0);
+            volk_32fc_s32fc_x2_rotator_32fc(&samples[0], &samples[0], expj(2 * M_PI * 0.3 / nbins), &phase, samples.size());
+        }
+    };
+
+    void BM_estimate_CFO(benchmark::State &state)
+    {
+        preamble pre(state.range(0));
+        for (auto _ : state)
+            frame_sync_engine_bench::estimate_CFO(pre.sync, &pre.samples[0]);
+        set_counters(state, pre.nsymbols * pre.nbins);
+        state.counters["symbols/s"] = benchmark::Counter(double(state.iterations()) * pre.nsymbols, benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_estimate_CFO)->Apply(sweep_sf);
+
+    void BM_estimate_STO(benchmark::State &state)
+    {
+        preamble pre(state.range(0));
+        //the STO is estimated on the preamble the CFO estimation corrected
+        frame_sync_engine_bench::estimate_CFO(pre.sync, &pre.samples[0]);
+        for (auto _ : state)
+            frame_sync_engine_bench::estimate_STO(pre.sync);
+        set_counters(state, pre.nsymbols * pre.nbins);
+        state.counters["symbols/s"] = benchmark::Counter(double(state.iterations()) * pre.nsymbols, benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_estimate_STO)->Apply(sweep_sf);
+
+    ////////////////////////////////////////////////////////////////////////
+    // CRC-16, over an alarm ID and over longer buffers
+    ////////////////////////////////////////////////////////////////////////
+
+    std::vector<uint8_t> random_bytes(size_t len)
+    {
+        std::vector<uint8_t> data(len);
+        std::mt19937 gen(1);
+        for (size_t i = 0; i < len; i++)
+            data[i] = gen();
+        return data;
+    }
+
+    // one table lookup per byte, as Crc_verif checks the symbols
+    void BM_crc16_bytewise(benchmark::State &state)
+    {
+        std::vector<uint8_t> data = random_bytes(state.range(0));
+        crc16 crc;
+        for (auto _ : state) {
+            crc.reset();
+            for (size_t i = 0; i < data.size(); i++)
+                crc.update(data[i]);
+            benchmark::DoNotOptimize(crc.value());
+        }
+        state.SetBytesProcessed(int64_t(state.iterations()) * data.size());
+    }
+    BENCHMARK(BM_crc16_bytewise)->Arg(1)->Arg(3)->Arg(64)->Arg(4096);
+
+    // slicing-by-8, as crcAppend and the PDU paths compute it
+    void BM_crc16_compute(benchmark::State &state)
+    {
+        std::vector<uint8_t> data = random_bytes(state.range(0));
+        for (auto _ : state)
+            benchmark::DoNotOptimize(crc16::compute(&data[0], data.size()));
+        state.SetBytesProcessed(int64_t(state.iterations()) * data.size());
+    }
+    BENCHMARK(BM_crc16_compute)->Arg(1)->Arg(3)->Arg(64)->Arg(4096);
+
+} // namespace
@@ -0,0 +1,72 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_ALARMRECEIVER_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_ALARMRECEIVER_H
+
+#include <CounterClockwiseAlarms/api.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /*!
+     * \brief Alarm receiver: FrameSync, ReceiveDown and Crc_verif in one block.
+     * \ingroup CounterClockwiseAlarms
+     *
+     * Synchronizes the frames, demodulates their symbols and checks their CRC in a single
+     * work call, without the buffers and tags between the three blocks. The output and the
+     * "msg" message port are the ones of Crc_verif: one byte, the alarm ID, per frame
+     * received, except that frames failing the CRC check are dropped. The "telemetry"
+     * message port is the one of FrameSync. The separate blocks expose the intermediate
+     * streams for debugging.
+     *
+     * Each byte of the CRC is received as one symbol, so the spreading factor is at least 8.
+     */
+    class COUNTERCLOCKWISEALARMS_API AlarmReceiver : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<AlarmReceiver> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of CounterClockwiseAlarms::AlarmReceiver.
+       *
+       * To avoid accidental use of raw pointers, CounterClockwiseAlarms::AlarmReceiver's
+       * constructor is in a private implementation
+       * class. CounterClockwiseAlarms::AlarmReceiver::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(float samp_rate, uint32_t bandwidth, uint8_t sf, std::vector<uint16_t> sync_word);
+
+      /*!
+       * \brief Same as FrameSync::set_squelch_threshold.
+       */
+      virtual void set_squelch_threshold(float threshold_db) = 0;
+
+      /*!
+       * \brief Same as FrameSync::set_max_frames.
+       */
+      virtual void set_max_frames(int max_frames) = 0;
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_ALARMRECEIVER_H */
@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_ALARMTRANSMITTER_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_ALARMTRANSMITTER_H
+
+#include <CounterClockwiseAlarms/api.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /*!
+     * \brief Alarm transmitter: mesCreater, crcAppend and DownModulate in one block.
+     * \ingroup CounterClockwiseAlarms
+     *
+     * Each alarm ID received on the "send" message port, as an integer, or given to
+     * send_alarm() becomes a frame: the ID followed by its CRC-16, modulated with the
+     * preamble straight into the output buffer and followed by inter_frame_padding zero
+     * symbols. A frame_len tag gives the length in samples of each frame, as DownModulate
+     * does. Nothing is output between alarms.
+     *
+     * Each byte of the CRC is sent as one symbol, so the spreading factor is at least 8.
+     */
+    class COUNTERCLOCKWISEALARMS_API AlarmTransmitter : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<AlarmTransmitter> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of CounterClockwiseAlarms::AlarmTransmitter.
+       *
+       * To avoid accidental use of raw pointers, CounterClockwiseAlarms::AlarmTransmitter's
+       * constructor is in a private implementation
+       * class. CounterClockwiseAlarms::AlarmTransmitter::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words, int inter_frame_padding = 0);
+
+      /*!
+       * \brief Send an alarm, from any thread.
+       */
+      virtual void send_alarm(uint8_t id) = 0;
+
+      /*!
+       * \brief Set the memory budget, in bytes, of the cache of modulated frames. The cache
+       * is shared by all the AlarmTransmitter and DownModulate blocks of the process: a frame
+       * is modulated the first time it is sent, later sends copy it. 64 MiB by default, 0
+       * disables the cache.
+       */
+      virtual void set_cache_budget(size_t bytes) = 0;
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_ALARMTRANSMITTER_H */
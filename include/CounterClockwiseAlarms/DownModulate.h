@@ -23,6 +23,7 @@
 
 #include <CounterClockwiseAlarms/api.h>
 #include <gnuradio/block.h>
+#include <CounterClockwiseAlarms/sample_format.h>
 
 namespace gr {
   namespace CounterClockwiseAlarms {
@@ -44,8 +45,23 @@ namespace gr {
        * constructor is in a private implementation
        * class. CounterClockwiseAlarms::DownModulate::make is the public interface for
        * creating new instances.
+       *
+       * \param format format of the output samples, sc16 and sc8 are written by the chirp synthesis
+       * \param full_scale integer value of an amplitude of 1.0, 0 for the default of the format;
+       *        samples beyond the integer range saturate
+       */
+      static sptr make(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words,
+                       sample_format format = SAMPLE_FC32, float full_scale = 0);
+
+      /*!
+       * \brief Switch to low-latency streaming output.
+       *
+       * Symbols may then be split across work calls so that any output
+       * buffer is filled, and at most \p max_samples samples are produced
+       * per call. 0 restores the output of whole symbols. To be called
+       * before the flowgraph starts.
        */
-      static sptr make(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words);
+      virtual void set_max_latency(int max_samples) = 0;
     };
 
   } // namespace CounterClockwiseAlarms
@@ -23,6 +23,7 @@
 
 #include <CounterClockwiseAlarms/api.h>
 #include <gnuradio/block.h>
+#include <CounterClockwiseAlarms/sample_format.h>
 
 namespace gr {
   namespace CounterClockwiseAlarms {
@@ -31,6 +32,8 @@ namespace gr {
      * \brief <+description of block+>
      * \ingroup CounterClockwiseAlarms
      *
+     * The "telemetry" message port publishes the offsets (CFO, STO, k_hat...) of every frame
+     * synchronized, as batches of sync_telemetry records, from a thread of its own.
      */
     class COUNTERCLOCKWISEALARMS_API FrameSync : virtual public gr::block
     {
@@ -44,8 +47,28 @@ namespace gr {
        * constructor is in a private implementation
        * class. CounterClockwiseAlarms::FrameSync::make is the public interface for
        * creating new instances.
+       *
+       * \param format format of the input samples, sc16 and sc8 are converted by the decimation filter
+       * \param full_scale integer value of an amplitude of 1.0, 0 for the default of the format
+       */
+      static sptr make(float samp_rate, uint32_t bandwidth, uint8_t sf, bool impl_head, std::vector<uint16_t> sync_word,
+                       sample_format format = SAMPLE_FC32, float full_scale = 0);
+
+      /*!
+       * \brief Skip the preamble search FFT on symbol windows whose energy is less than
+       * threshold_db above the tracked noise floor. A threshold of 0 dB or less disables
+       * the squelch (default). Frames received below threshold_db of SNR are lost while
+       * the squelch is enabled.
+       */
+      virtual void set_squelch_threshold(float threshold_db) = 0;
+
+      /*!
+       * \brief Set the number of frames synchronized at the same time (4 by default). The
+       * preamble search goes on while frames are being received, so a frame starting during
+       * another one is still caught. Each frame is output as a whole once its last symbol is
+       * received, frames overlapping in time come out one after the other.
        */
-      static sptr make(float samp_rate, uint32_t bandwidth, uint8_t sf, bool impl_head, std::vector<uint16_t> sync_word);
+      virtual void set_max_frames(int max_frames) = 0;
     };
 
   } // namespace CounterClockwiseAlarms
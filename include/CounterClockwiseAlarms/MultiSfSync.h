@@ -0,0 +1,70 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_MULTISFSYNC_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_MULTISFSYNC_H
+
+#include <CounterClockwiseAlarms/api.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /*!
+     * \brief Frame synchronization of several spreading factors on one sample stream.
+     * \ingroup CounterClockwiseAlarms
+     *
+     * Runs one FrameSync state machine per spreading factor directly on the shared
+     * input buffer. Output i carries the payload symbols of the frames found with
+     * sf[i], as vectors of 2^sf[i] samples with the same frame_info tags as FrameSync,
+     * and is meant to feed a ReceiveDown block configured with that spreading factor.
+     * The "telemetry" message port publishes the offsets of the frames of every spreading
+     * factor, as FrameSync does.
+     */
+    class COUNTERCLOCKWISEALARMS_API MultiSfSync : virtual public gr::block
+    {
+     public:
+      typedef boost::shared_ptr<MultiSfSync> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of CounterClockwiseAlarms::MultiSfSync.
+       *
+       * To avoid accidental use of raw pointers, CounterClockwiseAlarms::MultiSfSync's
+       * constructor is in a private implementation
+       * class. CounterClockwiseAlarms::MultiSfSync::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(float samp_rate, uint32_t bandwidth, std::vector<uint8_t> sf, std::vector<uint16_t> sync_word);
+
+      /*!
+       * \brief Same as FrameSync::set_squelch_threshold, applied to every spreading factor.
+       */
+      virtual void set_squelch_threshold(float threshold_db) = 0;
+
+      /*!
+       * \brief Same as FrameSync::set_max_frames, for each spreading factor.
+       */
+      virtual void set_max_frames(int max_frames) = 0;
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_MULTISFSYNC_H */
@@ -0,0 +1,47 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_DSP_COMPLEX_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_DSP_COMPLEX_H
+
+#include <cmath>
+#include <complex>
+
+/*!
+ * \brief Complex sample type of the DSP library, the same typedef as <gnuradio/gr_complex.h>,
+ * so that the library builds without GNU Radio and both headers may be included together.
+ */
+typedef std::complex<float> gr_complex;
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /*!
+     * \brief exp(j*phase), without gr_expj and the GNU Radio runtime it is implemented in
+     */
+    inline gr_complex expj(float phase)
+    {
+      return gr_complex(std::cos(phase), std::sin(phase));
+    }
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_DSP_COMPLEX_H */
@@ -28,9 +28,13 @@ namespace gr {
   namespace CounterClockwiseAlarms {
 
     /*!
-     * \brief <+description of block+>
+     * \brief Alarm frame source.
      * \ingroup CounterClockwiseAlarms
      *
+     * Each message on the "send" port gives one frame of framelen bytes: the ID carried by
+     * the message if it is an integer, mesDownId otherwise, followed by zeros. If the output
+     * is connected, the frame is written to the stream with the frame_len and payload_str
+     * tags crcAppend expects. Otherwise it is published as a PDU on "pdu".
      */
     class COUNTERCLOCKWISEALARMS_API mesCreater : virtual public gr::block
     {
@@ -0,0 +1,63 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_SAMPLE_FORMAT_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_SAMPLE_FORMAT_H
+
+#include <cstddef>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /*!
+     * \brief Format of the complex samples on the stream ports of FrameSync and DownModulate.
+     *
+     * SAMPLE_SC16 and SAMPLE_SC8 are interleaved I/Q integers, as most SDRs deliver and accept
+     * them. The conversion is folded into the decimation filter on receive and into the chirp
+     * synthesis on transmit. The full scale is the integer value of an amplitude of 1.0;
+     * transmitted samples beyond the integer range saturate.
+     */
+    enum sample_format
+    {
+      SAMPLE_FC32 = 0,  ///< complex float, gr_complex
+      SAMPLE_SC16 = 1,  ///< interleaved int16 I/Q
+      SAMPLE_SC8 = 2    ///< interleaved int8 I/Q
+    };
+
+    /*!
+     * \brief Size in bytes of one complex sample
+     */
+    inline size_t sample_size(sample_format format)
+    {
+      return format == SAMPLE_SC16 ? 4 : format == SAMPLE_SC8 ? 2 : 8;
+    }
+
+    /*!
+     * \brief Integer value of an amplitude of 1.0 when none is given, 1 for SAMPLE_FC32
+     */
+    inline float default_full_scale(sample_format format)
+    {
+      return format == SAMPLE_SC16 ? 32767.0f : format == SAMPLE_SC8 ? 127.0f : 1.0f;
+    }
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_SAMPLE_FORMAT_H */
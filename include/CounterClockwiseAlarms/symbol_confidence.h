@@ -0,0 +1,54 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_SYMBOL_CONFIDENCE_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_SYMBOL_CONFIDENCE_H
+
+#include <CounterClockwiseAlarms/api.h>
+#include <cstdint>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /*!
+     * \brief Confidence of one demodulated symbol.
+     *
+     * ReceiveDown writes one record per symbol on its optional second output, item for item
+     * with the symbol values of the first one. The strongest peaks of the dechirped spectrum
+     * are listed strongest first, at least 2 bins apart, as raw FFT bins without any shift;
+     * top_bin[0] is the symbol value, DownModulate sends the symbol values as they are. The
+     * layout is fixed: 40 bytes, fields in the order below.
+     */
+    struct symbol_confidence
+    {
+      static const int top_k = 4;   ///< number of peaks reported
+
+      float peak_ratio;             ///< energy of the strongest peak over the energy of the second one
+      float snr_db;                 ///< energy of the strongest peak over the energy of the other bins, in dB
+      uint32_t top_bin[top_k];      ///< FFT bins of the strongest peaks
+      float top_energy[top_k];      ///< energies of the strongest peaks
+    };
+
+    static_assert(sizeof(symbol_confidence) == 40, "symbol_confidence layout must not change");
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_SYMBOL_CONFIDENCE_H */
@@ -0,0 +1,57 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_SYNC_TELEMETRY_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_SYNC_TELEMETRY_H
+
+#include <cstdint>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /*!
+     * \brief Synchronization offsets of one received frame.
+     *
+     * FrameSync and MultiSfSync publish these records on their "telemetry" message port, in
+     * batches: each message is a PDU whose metadata dict holds "records" (the number of
+     * records), "record_size" (sizeof(sync_telemetry)) and "dropped" (the number of records
+     * lost so far because the publisher fell behind), and whose u8vector holds the records
+     * back to back. The layout is fixed: 32 bytes, little endian on every supported host,
+     * fields in the order below.
+     */
+    struct sync_telemetry
+    {
+      uint64_t sample_index;  ///< input sample index of the first payload symbol of the frame
+      float lambda_cfo;       ///< fractional part of the CFO, in bins
+      float lambda_sto;       ///< fractional part of the STO, in chips
+      int32_t k_hat;          ///< integer part of CFO+STO found on the preamble, in bins
+      int32_t cfo_int;        ///< integer part of the CFO, in bins
+      uint32_t frame_cnt;     ///< number of frames synchronized before this one by the same detector
+      int8_t net_id_off;      ///< offset of the received network identifier, -1, 0 or 1
+      uint8_t sf;             ///< spreading factor
+      uint16_t reserved;      ///< always 0
+    };
+
+    static_assert(sizeof(sync_telemetry) == 32, "sync_telemetry layout must not change");
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_SYNC_TELEMETRY_H */
@@ -1,11 +1,15 @@
 #ifndef UTILITIES_H
 #define UTILITIES_H
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <string.h>
 #include <iomanip>
 #include <numeric>
-#include <gnuradio/expj.h>
+#include <string>
+#include <vector>
+#include <CounterClockwiseAlarms/dsp_complex.h>
 #include <sys/resource.h>
 #include <sys/syscall.h>
 #include <volk/volk.h>
@@ -66,9 +70,9 @@ namespace gr {
             int n_fold = N* os_factor - id*os_factor;
             for(uint n = 0; n < N* os_factor; n++){
                 if(n<n_fold)
-                    chirp[n] = gr_complex(1.0,0.0)*gr_expj(2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N-0.5)*n/os_factor));
+                    chirp[n] = gr_complex(1.0,0.0)*gr::CounterClockwiseAlarms::expj(2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N-0.5)*n/os_factor));
                 else
-                    chirp[n] = gr_complex(1.0,0.0)*gr_expj(2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N-1.5)*n/os_factor));
+                    chirp[n] = gr_complex(1.0,0.0)*gr::CounterClockwiseAlarms::expj(2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N-1.5)*n/os_factor));
 
             }
         }
@@ -89,9 +93,9 @@ namespace gr {
             int n_fold = N* os_factor - id*os_factor;
             for(uint n = 0; n < N* os_factor; n++){
                 if(n<n_fold)
-                    chirp[n] = gr_complex(1.0,0.0)*gr_expj(-2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N-0.5)*n/os_factor));
+                    chirp[n] = gr_complex(1.0,0.0)*gr::CounterClockwiseAlarms::expj(-2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N-0.5)*n/os_factor));
                 else
-                    chirp[n] = gr_complex(1.0,0.0)*gr_expj(-2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N+0.5)*(n-n_fold)/os_factor));
+                    chirp[n] = gr_complex(1.0,0.0)*gr::CounterClockwiseAlarms::expj(-2.0*M_PI *(n*n/(2*N)/pow(os_factor,2)+(id/N+0.5)*(n-n_fold)/os_factor));
             }
         }
 
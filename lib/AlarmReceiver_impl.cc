@@ -0,0 +1,164 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <algorithm>
+#include <stdexcept>
+#include <volk/volk.h>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "AlarmReceiver_impl.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    AlarmReceiver::sptr
+    AlarmReceiver::make(float samp_rate, uint32_t bandwidth, uint8_t sf, std::vector<uint16_t> sync_word)
+    {
+      //each byte of the CRC is received as one symbol, SF7 symbols only carry 7 bits
+      if (sf < 8)
+          throw std::invalid_argument("AlarmReceiver: the spreading factor must be at least 8");
+      return gnuradio::get_initial_sptr
+        (new AlarmReceiver_impl(samp_rate, bandwidth, sf, sync_word));
+    }
+
+
+    /*
+     * The private constructor
+     */
+    AlarmReceiver_impl::AlarmReceiver_impl(float samp_rate, uint32_t bandwidth, uint8_t sf, std::vector<uint16_t> sync_word)
+      : gr::block("AlarmReceiver",
+              gr::io_signature::make(1, 1, sizeof(gr_complex)),
+              gr::io_signature::make(0, 1, sizeof(uint8_t))),
+        m_sync(samp_rate, bandwidth, sf, sync_word),
+        m_telemetry([this](pmt::pmt_t msg) { message_port_pub(pmt::mp("telemetry"), msg); })
+    {
+      m_sf = sf;
+      m_samples_per_symbol = 1u << m_sf;
+      //control frames are fixed: the alarm ID followed by its CRC
+      m_pay_len = 1;
+      m_has_crc = 1;
+      m_symb_numb = m_pay_len+m_has_crc*2;
+      m_sync.set_symb_numb(m_symb_numb);
+
+      //room for a few frames per call, the symbols never leave the block
+      m_max_symbols = 8*m_symb_numb;
+      m_symbols.resize(m_max_symbols*m_samples_per_symbol);
+
+      m_chirps = &chirp_table::get(m_sf);
+      m_downchirp.resize(m_samples_per_symbol);
+      m_demod = symbol_demodulator::make(m_sf);
+      m_symb_cnt = 0;
+      m_id = 0;
+
+      message_port_register_out(pmt::mp("msg"));
+      message_port_register_out(pmt::mp("telemetry"));
+      m_sync.set_telemetry(&m_telemetry.ring());
+    }
+
+    /*
+     * Our virtual destructor.
+     */
+    AlarmReceiver_impl::~AlarmReceiver_impl()
+    {
+    }
+
+    void AlarmReceiver_impl::set_squelch_threshold(float threshold_db)
+    {
+        m_sync.set_squelch_threshold(threshold_db);
+    }
+
+    void AlarmReceiver_impl::set_max_frames(int max_frames)
+    {
+        m_sync.set_max_frames(max_frames);
+    }
+
+    bool AlarmReceiver_impl::start()
+    {
+        m_telemetry.start();
+        return block::start();
+    }
+
+    bool AlarmReceiver_impl::stop()
+    {
+        m_telemetry.stop();
+        return block::stop();
+    }
+
+    void
+    AlarmReceiver_impl::forecast (int /*noutput_items*/, gr_vector_int &ninput_items_required)
+    {
+      /* <+forecast+> e.g. ninput_items_required[0] = noutput_items */
+        ninput_items_required[0] = m_sync.window_len();
+    }
+
+    int
+    AlarmReceiver_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+      const gr_complex *in = (const gr_complex *) input_items[0];
+      uint8_t *out = output_items.size() ? (uint8_t *) output_items[0] : 0;
+      int consumed;
+
+      //each frame gives one output byte, a frame left unfinished by the last call included
+      int max_symbols = m_max_symbols;
+      if(out)
+          max_symbols = std::min<int64_t>(max_symbols, (int64_t)noutput_items*m_symb_numb);
+
+      m_frames.clear();
+      int nsymbols = m_sync.work(in, ninput_items[0], &m_symbols[0], max_symbols, consumed, m_frames);
+
+      int produced = 0;
+      size_t frame = 0;
+      for (int i = 0; i < nsymbols; i++) {
+          if(frame < m_frames.size() && m_frames[frame].out_index == i){
+              //create the downchirp taking CFOint into account, as ReceiveDown does
+              m_chirps->upchirp(&m_downchirp[0], lora_sdr::mod(m_frames[frame].cfo_int, m_samples_per_symbol));
+              volk_32fc_conjugate_32fc(&m_downchirp[0], &m_downchirp[0], m_samples_per_symbol);
+              m_symb_cnt = 0;
+              m_crc.reset();
+              frame++;
+          }
+          demod_result res;
+          m_demod->demod(&m_symbols[i*m_samples_per_symbol], &m_downchirp[0], res);
+          uint8_t value = res.bin;
+          if(m_symb_cnt == 0)
+              m_id = value;
+          //the CRC of the ID followed by its CRC is 0, as in Crc_verif
+          m_crc.update(value);
+          //a frame failing the CRC check raises no alarm
+          if(++m_symb_cnt == m_symb_numb && m_crc.value() == 0){
+              if(out)
+                  out[produced] = m_id;
+              produced++;
+              message_port_pub(pmt::mp("msg"), pmt::from_uint64(m_id));
+          }
+      }
+      consume_each(consumed);
+      return out ? produced : 0;
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_ALARMRECEIVER_IMPL_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_ALARMRECEIVER_IMPL_H
+
+#include <CounterClockwiseAlarms/AlarmReceiver.h>
+#include <memory>
+#include "chirp_table.h"
+#include "crc16.h"
+#include "frame_sync_engine.h"
+#include "symbol_demod.h"
+#include "telemetry_publisher.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    class AlarmReceiver_impl : public AlarmReceiver
+    {
+     private:
+        uint8_t m_sf;                       ///< Spreading factor
+        uint32_t m_samples_per_symbol;      ///< Number of samples per symbol after synchronization
+        uint32_t m_pay_len;                 ///< Payload length, the alarm ID
+        uint8_t m_has_crc;                  ///< CRC presence
+        uint32_t m_symb_numb;               ///< Number of symbols of a frame, payload and CRC
+
+        frame_sync_engine m_sync;           ///< preamble detection and synchronization DSP
+        std::vector<frame_start> m_frames;  ///< frames synchronized during the current work call
+        std::vector<gr_complex> m_symbols;  ///< payload symbols synchronized during the current work call
+        int m_max_symbols;                  ///< capacity of m_symbols, in symbols
+        telemetry_publisher m_telemetry;    ///< publishes the offsets of the frames on the telemetry port
+
+        const chirp_table *m_chirps;        ///< Shared table of the modulated chirps
+        std::vector<gr_complex> m_downchirp; ///< Reference downchirp of the current frame
+        std::unique_ptr<symbol_demodulator> m_demod; ///< Demodulation kernel of the spreading factor
+
+        uint32_t m_symb_cnt;                ///< Number of symbols of the current frame demodulated
+        uint8_t m_id;                       ///< Alarm ID of the current frame
+        crc16 m_crc;                        ///< CRC of the symbols of the current frame demodulated
+
+     public:
+      AlarmReceiver_impl(float samp_rate, uint32_t bandwidth, uint8_t sf, std::vector<uint16_t> sync_word);
+      ~AlarmReceiver_impl();
+
+      void set_squelch_threshold(float threshold_db);
+      void set_max_frames(int max_frames);
+
+      bool start();
+      bool stop();
+
+      // Where all the action really happens
+      void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+      int general_work(int noutput_items,
+           gr_vector_int &ninput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items);
+
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_ALARMRECEIVER_IMPL_H */
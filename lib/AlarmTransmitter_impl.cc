@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <stdexcept>
+#include "AlarmTransmitter_impl.h"
+#include "crc16.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    AlarmTransmitter::sptr
+    AlarmTransmitter::make(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words, int inter_frame_padding)
+    {
+      //each byte of the CRC is sent as one symbol, SF7 symbols only carry 7 bits
+      if (sf < 8)
+          throw std::invalid_argument("AlarmTransmitter: the spreading factor must be at least 8");
+      return gnuradio::get_initial_sptr
+        (new AlarmTransmitter_impl(sf, samp_rate, bw, sync_words, inter_frame_padding));
+    }
+
+
+    /*
+     * The private constructor
+     */
+    AlarmTransmitter_impl::AlarmTransmitter_impl(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words, int inter_frame_padding)
+      : gr::block("AlarmTransmitter",
+              gr::io_signature::make(0, 0, 0),
+              gr::io_signature::make(1, 1, sizeof(gr_complex))),
+        m_modulator(sf, samp_rate, bw, sync_words)
+    {
+      m_modulator.set_inter_frame_padding(inter_frame_padding);
+      m_send_port = pmt::mp("send");
+      m_frame_len_key = pmt::string_to_symbol("frame_len");
+
+      set_tag_propagation_policy(TPP_DONT);
+      message_port_register_in(m_send_port);
+      set_msg_handler(m_send_port, boost::bind(&AlarmTransmitter_impl::send_handler, this, _1));
+    }
+
+    /*
+     * Our virtual destructor.
+     */
+    AlarmTransmitter_impl::~AlarmTransmitter_impl()
+    {
+    }
+
+    void AlarmTransmitter_impl::send_alarm(uint8_t id)
+    {
+        //going through the message queue wakes the block up and keeps the queue to its own thread
+        _post(m_send_port, pmt::from_long(id));
+    }
+
+    void AlarmTransmitter_impl::set_cache_budget(size_t bytes)
+    {
+        waveform_cache::instance().set_budget(bytes);
+    }
+
+    void AlarmTransmitter_impl::send_handler(pmt::pmt_t msg)
+    {
+        if (!pmt::is_integer(msg))
+        {
+            std::cerr << "[AlarmTransmitter] WARNING : alarm ID expected, message dropped\n";
+            return;
+        }
+        //the ID followed by its CRC, low byte first, as crcAppend sends it
+        uint8_t frame[3];
+        frame[0] = pmt::to_long(msg);
+        uint16_t crc = crc16::compute(frame, 1);
+        frame[1] = crc & 0xff;
+        frame[2] = crc >> 8;
+        m_modulator.push(frame, 3);
+    }
+
+    int
+    AlarmTransmitter_impl::general_work (int noutput_items,
+                       gr_vector_int &/*ninput_items*/,
+                       gr_vector_const_void_star &/*input_items*/,
+                       gr_vector_void_star &output_items)
+    {
+      gr_complex *out = (gr_complex *) output_items[0];
+
+      m_frames.clear();
+      int produced = m_modulator.output(out, noutput_items, m_frames);
+      for (size_t i = 0; i < m_frames.size(); i++)
+          add_item_tag(0, nitems_written(0) + m_frames[i].offset, m_frame_len_key, pmt::from_long(m_frames[i].nsamples));
+
+      // Tell runtime system how many output items we produced.
+      return produced;
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
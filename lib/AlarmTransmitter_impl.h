@@ -0,0 +1,60 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_ALARMTRANSMITTER_IMPL_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_ALARMTRANSMITTER_IMPL_H
+
+#include <CounterClockwiseAlarms/AlarmTransmitter.h>
+#include "frame_modulator.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    class AlarmTransmitter_impl : public AlarmTransmitter
+    {
+     private:
+        frame_modulator m_modulator;        ///< modulates the queued frames
+        std::vector<frame_position> m_frames; ///< frames started during the current work call
+        pmt::pmt_t m_send_port;             ///< port the alarms to send arrive on
+        pmt::pmt_t m_frame_len_key;         ///< key of the frame tags
+
+        /**
+         *  \brief  Queue the frame of the alarm ID carried by the message.
+         */
+        void send_handler(pmt::pmt_t msg);
+
+     public:
+      AlarmTransmitter_impl(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words, int inter_frame_padding);
+      ~AlarmTransmitter_impl();
+
+      void send_alarm(uint8_t id);
+      void set_cache_budget(size_t bytes);
+
+      int general_work(int noutput_items,
+           gr_vector_int &ninput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items);
+
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_ALARMTRANSMITTER_IMPL_H */
@@ -46,7 +46,9 @@ namespace gr {
         m_frequency(frequency),
         m_sf(sf)
     {
-        m_payload_len = 1 + m_crc_presence * 4;
+        //control frames are fixed: the alarm ID followed by its CRC-16
+        m_crc_presence = true;
+        m_payload_len = 1 + m_crc_presence * 2;
          message_port_register_out(pmt::mp("msg"));
     }
 
@@ -64,27 +66,6 @@ namespace gr {
       ninput_items_required[0] = 1; //m_payload_len;
     }
 
-    unsigned int Calculate_crc16(std::vector<uint8_t> DAT, unsigned int length);
-    {
-        unsigned int CRC = 0xffff;
-        unsigned char i;
-        unsigned char j;
-        for (i = 0; i < length; i++)
-        {
-            CRC = CRC ^ DAT[i];
-            for(j = 0; j < 8;j++){
-                if(CRC & 0x01){
-                    CRC = CRC >> 1;
-                    CRC = CRC ^ 0xA001;
-                }else{
-                    CRC = CRC >> 1;
-                }
-                
-            }
-        }
-        return CRC;
-    }
-
     int
     Crc_verif_impl::general_work (int noutput_items,
                        gr_vector_int &ninput_items,
@@ -94,11 +75,12 @@ namespace gr {
       const uint32_t *in = (const uint32_t *) input_items[0];
       uint8_t *out = (uint8_t *) output_items[0];
       if(ninput_items[0] >= (int)m_payload_len){
-        for(int i = 0;i < m_payload_len;i++){
-          in_buff.push_back(in[i]);
+        //the symbols carry one byte each, the CRC of the bytes followed by their CRC is 0
+        crc16 crc;
+        for(uint32_t i = 0;i < m_payload_len;i++){
+          crc.update((uint8_t)in[i]);
         }
-        int crcResult = Calculate_crc16(in_buff,m_payload_len);
-        if(crcResult == 0){
+        if(crc.value() == 0){
           std::cout<<"CRC valid"<<std::endl;
         }else{
           std::cout<<"CRC Invalid"<<std::endl;
@@ -22,6 +22,7 @@
 #define INCLUDED_COUNTERCLOCKWISEALARMS_CRC_VERIF_IMPL_H
 
 #include <CounterClockwiseAlarms/Crc_verif.h>
+#include "crc16.h"
 
 namespace gr {
   namespace CounterClockwiseAlarms {
@@ -35,7 +36,6 @@ namespace gr {
         std::string message_str;///< The payload string
         char m_char;///< A new char of the payload
         bool new_frame; ///<indicate a new frame
-        std::vector<uint8_t> in_buff;///< input buffer containing the data bytes and CRC if any
 
         uint32_t cnt=0;///< count the number of frame
         uint8_t m_frequency,m_sf;
@@ -49,15 +49,6 @@ namespace gr {
          *  \brief  Handles the crc_presence received from the header_decoder block.
          */
         void header_crc_handler(pmt::pmt_t crc_presence);
-        /**
-         *  \brief  Calculate the CRC 16 using poly=0x1021 and Init=0x0000
-         *
-         *  \param  data
-         *          The pointer to the data beginning.
-         *  \param  len
-         *          The length of the data in bytes.
-         */
-        unsigned int Calculate_crc16(uint8_t* data, uint32_t len);
 
      public:
       Crc_verif_impl(double frequency,uint8_t sf);
@@ -22,6 +22,8 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <gnuradio/io_signature.h>
 #include "DownModulate_impl.h"
 
@@ -29,20 +31,24 @@ namespace gr {
   namespace CounterClockwiseAlarms {
 
     DownModulate::sptr
-    DownModulate::make(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words)
+    DownModulate::make(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words,
+                       sample_format format, float full_scale)
     {
       return gnuradio::get_initial_sptr
-        (new DownModulate_impl(sf,samp_rate,bw,sync_words));
+        (new DownModulate_impl(sf,samp_rate,bw,sync_words,format,full_scale));
     }
 
 
     /*
      * The private constructor
      */
-    DownModulate_impl::DownModulate_impl(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words)
+    DownModulate_impl::DownModulate_impl(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words,
+                                         sample_format format, float full_scale)
       : gr::block("DownModulate",
-              gr::io_signature::make(1, 1, sizeof(uint32_t)),
-              gr::io_signature::make(1, 1, sizeof(gr_complex)))
+              gr::io_signature::make(0, 1, sizeof(uint32_t)),
+              gr::io_signature::make(1, 1, sample_size(format))),
+        m_nco(sf, samp_rate, bw),
+        m_modulator(sf, samp_rate, bw, sync_words)
     {
         m_sf = sf;
         m_samp_rate = samp_rate;
@@ -50,14 +56,12 @@ namespace gr {
         m_sync_words = sync_words;
 
         m_number_of_bins = (uint32_t)(1u << m_sf);
-        m_os_factor = m_samp_rate / m_bw;
-        m_samples_per_symbol = (uint32_t)(m_number_of_bins*m_os_factor);
-
-        m_downchirp.resize(m_samples_per_symbol);
-        m_upchirp.resize(m_samples_per_symbol);
-
-
-        build_ref_chirps(&m_upchirp[0], &m_downchirp[0], m_sf,m_os_factor);
+        //samp_rate needs not be a multiple of bw, symbols then differ by one sample
+        m_samples_per_symbol = m_nco.max_samples();
+        //integer samples are written by the chirp synthesis and by the copy of the PDU frames
+        m_nco.set_output_format(format, full_scale);
+        m_modulator.set_output_format(format, full_scale);
+        m_sample_size = sample_size(format);
 
         if(m_sync_words.size()==1){
           uint16_t tmp = m_sync_words[0];
@@ -70,12 +74,21 @@ namespace gr {
         symb_cnt = -1;
         preamb_symb_cnt = 0;
         frame_cnt = 0;
+        m_inter_frame_padding = 0;
+        m_frame_len = 0;
+        m_frame_tag_offset = (uint64_t)-1;
+        m_max_latency = 0;
+        m_partial.resize(m_samples_per_symbol * m_sample_size);
+        m_partial_len = 0;
+        m_partial_read = 0;
+        m_frame_len_key = pmt::string_to_symbol("frame_len");
 
         set_tag_propagation_policy(TPP_DONT);
         set_output_multiple(m_samples_per_symbol);
 
-
-
+        // PDU mode: each message is a whole frame, modulated in one pass without stream tags
+        message_port_register_in(pmt::mp("pdu"));
+        set_msg_handler(pmt::mp("pdu"), boost::bind(&DownModulate_impl::pdu_handler, this, _1));
     }
 
     /*
@@ -85,11 +98,81 @@ namespace gr {
     {
     }
 
+    void
+    DownModulate_impl::set_max_latency(int max_samples)
+    {
+        m_max_latency = std::max(max_samples, 0);
+        if (m_max_latency)
+        {
+            //symbols are split across calls, any output buffer is filled
+            set_output_multiple(1);
+            set_max_noutput_items(m_max_latency);
+        }
+        else
+        {
+            set_output_multiple(m_samples_per_symbol);
+            unset_max_noutput_items();
+        }
+    }
+
+    void
+    DownModulate_impl::pdu_handler(pmt::pmt_t msg)
+    {
+        if (!pmt::is_pair(msg) || !pmt::is_u8vector(pmt::cdr(msg)))
+        {
+            std::cerr << "[DownModulate] WARNING : PDU expected, message dropped\n";
+            return;
+        }
+        size_t len;
+        const uint8_t *payload = pmt::u8vector_elements(pmt::cdr(msg), len);
+        m_modulator.push(payload, len);
+    }
+
+    int
+    DownModulate_impl::output_pdus(uint8_t *out, int output_offset, int noutput_items)
+    {
+        m_pdu_frames.clear();
+        int nsamples = m_modulator.output(out + output_offset * m_sample_size, noutput_items - output_offset, m_pdu_frames);
+        for (size_t i = 0; i < m_pdu_frames.size(); i++)
+        {
+            add_item_tag(0, nitems_written(0) + output_offset + m_pdu_frames[i].offset, m_frame_len_key, pmt::from_long(m_pdu_frames[i].nsamples));
+            frame_cnt++;
+        }
+        return output_offset + nsamples;
+    }
+
+    bool
+    DownModulate_impl::has_room(int room) const
+    {
+        return m_max_latency ? room > 0 : room >= (int)m_samples_per_symbol;
+    }
+
+    uint8_t *
+    DownModulate_impl::symbol_dest(uint8_t *out, int room)
+    {
+        return room >= (int)m_samples_per_symbol ? out : &m_partial[0];
+    }
+
+    int
+    DownModulate_impl::symbol_done(uint8_t *out, int room, int nsamples)
+    {
+        if (room >= (int)m_samples_per_symbol)
+            return nsamples;
+        //the rest of the symbol goes first in the next call
+        int n = std::min(nsamples, room);
+        memcpy(out, &m_partial[0], n * m_sample_size);
+        m_partial_len = nsamples;
+        m_partial_read = n;
+        return n;
+    }
+
     void
     DownModulate_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
     {
       /* <+forecast+> e.g. ninput_items_required[0] = noutput_items */
-      ninput_items_required[0] = 1;
+      //the frames received as PDUs and the end of a split symbol need no input
+      if (ninput_items_required.size())
+          ninput_items_required[0] = m_modulator.pending() || m_partial_read < m_partial_len ? 0 : 1;
     }
 
     int
@@ -98,75 +181,98 @@ namespace gr {
                        gr_vector_const_void_star &input_items,
                        gr_vector_void_star &output_items)
     {
+            uint8_t *out = (uint8_t *)output_items[0];
+            int output_offset = 0;
+            //the end of a symbol split across calls goes out first
+            if (m_partial_read < m_partial_len)
+            {
+                output_offset = std::min(m_partial_len - m_partial_read, noutput_items);
+                memcpy(out, &m_partial[m_partial_read * m_sample_size], output_offset * m_sample_size);
+                m_partial_read += output_offset;
+                if (m_partial_read < m_partial_len)
+                {
+                    consume_each(0);
+                    return output_offset;
+                }
+            }
+            //PDU frames go out between stream frames, never in the middle of one
+            bool stream_idle = symb_cnt > m_frame_len + m_inter_frame_padding || (symb_cnt == -1 && preamb_symb_cnt == 0);
+            if (ninput_items.empty() || (stream_idle && m_modulator.pending()))
+            {
+                consume_each(0);
+                return output_pdus(out, output_offset, noutput_items);
+            }
+
             const uint32_t *in = (const uint32_t *)input_items[0];
-            gr_complex *out = (gr_complex *)output_items[0];
             int nitems_to_process = ninput_items[0];
-            int output_offset = 0;
             // read tags
             std::vector<tag_t> tags;
 
-            get_tags_in_window(tags, 0, 0, ninput_items[0], pmt::string_to_symbol("frame_len"));
+            get_tags_in_window(tags, 0, 0, ninput_items[0], m_frame_len_key);
             if (tags.size())
             {
                 if (tags[0].offset != nitems_read(0))
-                    nitems_to_process = std::min(tags[0].offset - nitems_read(0), (uint64_t)(float)noutput_items / m_samples_per_symbol);
+                    nitems_to_process = tags[0].offset - nitems_read(0);
                 else
                 {
                     if (tags.size() >= 2)
-                        nitems_to_process = std::min(tags[1].offset - tags[0].offset, (uint64_t)(float)noutput_items / m_samples_per_symbol);
-                   
+                        nitems_to_process = tags[1].offset - tags[0].offset;
+
+                    //the preamble may span several calls before the first payload item is consumed
+                    if (tags[0].offset != m_frame_tag_offset)
+                    {
+                        m_frame_tag_offset = tags[0].offset;
                         m_frame_len = pmt::to_long(tags[0].value);
-                        tags[0].offset = nitems_written(0);
+                        tags[0].offset = nitems_written(0) + output_offset;
 
-                        tags[0].value = pmt::from_long(int((m_frame_len + n_up + 4.25) * m_samples_per_symbol));
+                        //the symbol boundaries of the frame start on this sample
+                        m_nco.restart();
+                        tags[0].value = pmt::from_long(m_nco.samples(4 * (m_frame_len + n_up + 4) + 1));
 
                         add_item_tag(0, tags[0]);
 
                         symb_cnt = -1;
                         preamb_symb_cnt = 0;
                         padd_cnt = 0;
-                  
+                    }
                 }
             }
 
             if (symb_cnt == -1) // preamble
             {
-                for (int i = 0; i < noutput_items / m_samples_per_symbol; i++)
+                while (preamb_symb_cnt < n_up + 5 && has_room(noutput_items - output_offset)) //should output preamble part
                 {
-                    if (preamb_symb_cnt < n_up + 5) //should output preamble part
+                    uint8_t *dest = symbol_dest(out + output_offset * m_sample_size, noutput_items - output_offset);
+                    int nsamples;
+                    if (preamb_symb_cnt < n_up) //upchirps
+                        nsamples = m_nco.upchirp(dest, 0);
+                    else if (preamb_symb_cnt == n_up) //sync words
+                        nsamples = m_nco.upchirp(dest, m_sync_words[0]);
+                    else if (preamb_symb_cnt == n_up + 1)
+                        nsamples = m_nco.upchirp(dest, m_sync_words[1]);
+                    else if (preamb_symb_cnt < n_up + 4) //2.25 downchirps
+                        nsamples = m_nco.downchirp(dest);
+                    else
                     {
-                        if (preamb_symb_cnt < n_up)
-                        { //upchirps
-                            memcpy(&out[output_offset], &m_upchirp[0], m_samples_per_symbol * sizeof(gr_complex));
-                        }
-                        else if (preamb_symb_cnt == n_up) //sync words
-                            build_upchirp(&out[output_offset], m_sync_words[0], m_sf,m_os_factor);
-                        else if (preamb_symb_cnt == n_up + 1)
-                            build_upchirp(&out[output_offset], m_sync_words[1], m_sf,m_os_factor);
-
-                        else if (preamb_symb_cnt < n_up + 4) //2.25 downchirps
-                            memcpy(&out[output_offset], &m_downchirp[0], m_samples_per_symbol * sizeof(gr_complex));
-                        else if (preamb_symb_cnt == n_up + 4)
-                        {
-                            memcpy(&out[output_offset], &m_downchirp[0], m_samples_per_symbol / 4 * sizeof(gr_complex));
-                            //correct offset dur to quarter of downchirp
-                            output_offset -= 3 * m_samples_per_symbol / 4;
-                            symb_cnt = 0;
-                        }
-                        output_offset += m_samples_per_symbol;
-                        preamb_symb_cnt++;
+                        nsamples = m_nco.downchirp(dest, 1);
+                        symb_cnt = 0;
                     }
+                    output_offset += symbol_done(out + output_offset * m_sample_size, noutput_items - output_offset, nsamples);
+                    preamb_symb_cnt++;
                 }
             }
-            
+
             if ( symb_cnt < m_frame_len && symb_cnt>-1) //output payload
             {
-                nitems_to_process = std::min(nitems_to_process, int((float)(noutput_items - output_offset) / m_samples_per_symbol));
+                //in streaming mode the last symbol may be split
+                int room = noutput_items - output_offset;
+                nitems_to_process = std::min(nitems_to_process, int((room + (m_max_latency ? m_samples_per_symbol - 1 : 0)) / m_samples_per_symbol));
                 nitems_to_process = std::min(nitems_to_process, ninput_items[0]);
+                nitems_to_process = std::min(nitems_to_process, m_frame_len - symb_cnt);
                 for (int i = 0; i < nitems_to_process; i++)
                 {
-                    build_upchirp(&out[output_offset], in[i], m_sf,m_os_factor);
-                    output_offset += m_samples_per_symbol;
+                    uint8_t *dest = symbol_dest(out + output_offset * m_sample_size, noutput_items - output_offset);
+                    output_offset += symbol_done(out + output_offset * m_sample_size, noutput_items - output_offset, m_nco.upchirp(dest, in[i]));
                     symb_cnt++;
                 }
             }
@@ -177,18 +283,12 @@ namespace gr {
 
             if (symb_cnt >= m_frame_len) //padd frame end with zeros
             {
-                for (int i = 0; i < (noutput_items - output_offset) / m_samples_per_symbol; i++)
+                while (symb_cnt < m_frame_len + m_inter_frame_padding && has_room(noutput_items - output_offset))
                 {
-                    if (symb_cnt < m_frame_len + m_inter_frame_padding)
-                    {
-                        for (int i = 0; i < m_samples_per_symbol; i++)
-                        {
-                            out[output_offset + i] = gr_complex(0.0, 0.0);
-                        }
-                        output_offset += m_samples_per_symbol;
-                        symb_cnt++;
-                        padd_cnt++;
-                    }
+                    uint8_t *dest = symbol_dest(out + output_offset * m_sample_size, noutput_items - output_offset);
+                    output_offset += symbol_done(out + output_offset * m_sample_size, noutput_items - output_offset, m_nco.zeros(dest));
+                    symb_cnt++;
+                    padd_cnt++;
                 }
             }
             if ( symb_cnt == m_frame_len + m_inter_frame_padding)
@@ -198,8 +298,6 @@ namespace gr {
                 std::cout << "Frame " << frame_cnt << " sent\n";
             }
             
-            // if (nitems_to_process)
-            //     std::cout << ninput_items[0] << " " << nitems_to_process << " " << output_offset << " " << noutput_items << std::endl;
             consume_each(nitems_to_process);
             return output_offset;
     }
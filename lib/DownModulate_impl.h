@@ -22,6 +22,8 @@
 #define INCLUDED_COUNTERCLOCKWISEALARMS_DOWNMODULATE_IMPL_H
 
 #include <CounterClockwiseAlarms/DownModulate.h>
+#include "chirp_nco.h"
+#include "frame_modulator.h"
 
 namespace gr {
   namespace CounterClockwiseAlarms {
@@ -33,17 +35,22 @@ namespace gr {
         uint32_t m_samp_rate; ///< Transmission sampling rate
         uint32_t m_bw; ///< Transmission bandwidth (Works only for samp_rate=bw)
         uint32_t m_number_of_bins; ///< number of bin per loar symbol
-        uint32_t m_samples_per_symbol; ///< samples per symbols(Works only for 2^sf)
+        uint32_t m_samples_per_symbol; ///< samples per symbols, rounded up
+        size_t m_sample_size; ///< size in bytes of an output sample
         std::vector<uint16_t> m_sync_words; ///< sync words (network id) 
 
-        int m_os_factor; ///< ovesampling factor based on sampling rate and bandwidth
 
         int m_inter_frame_padding; ///< length in samples of zero append to each frame
 
         int m_frame_len;///< leng of the frame in number of items
+        uint64_t m_frame_tag_offset; ///< input offset of the last frame tag handled
        
-        std::vector<gr_complex> m_upchirp; ///< reference upchirp
-        std::vector<gr_complex> m_downchirp; ///< reference downchirp
+        chirp_nco m_nco; ///< chirp synthesizer of the stream frames
+
+        int m_max_latency; ///< maximum number of samples output per call, 0 to output whole symbols only
+        std::vector<uint8_t> m_partial; ///< symbol split across work calls, in the output format
+        int m_partial_len; ///< number of samples of the split symbol
+        int m_partial_read; ///< number of samples of the split symbol already output
 
         uint n_up; ///< number of upchirps in the preamble
         int32_t symb_cnt; ///< counter of the number of lora symbols sent
@@ -51,10 +58,62 @@ namespace gr {
         uint32_t padd_cnt; ///< counter of the number of null symbols output after each frame
         uint64_t frame_cnt; ///< counter of the number of frame sent
 
+        frame_modulator m_modulator; ///< modulates the frames received as PDUs
+        std::vector<frame_position> m_pdu_frames; ///< PDU frames started during the current work call
+        pmt::pmt_t m_frame_len_key; ///< key of the frame tags
+
+        /**
+         *  \brief  Queue the payload of a PDU for modulation.
+         */
+        void pdu_handler(pmt::pmt_t msg);
+
+        /**
+         *  \brief  Output the frames received as PDUs.
+         *
+         *  \param  output_offset
+         *          number of samples already written to the output buffer
+         *  \return The number of samples in the output buffer
+         */
+        int output_pdus(uint8_t *out, int output_offset, int noutput_items);
+
+        /**
+         *  \brief  Tell whether a stream symbol can be started in the remaining output.
+         *
+         *  \param  room
+         *          number of samples left in the output buffer
+         */
+        bool has_room(int room) const;
+
+        /**
+         *  \brief  Return where to write the next stream symbol, the split symbol buffer if it does not fit in the output.
+         *
+         *  \param  out
+         *          current position in the output buffer
+         *  \param  room
+         *          number of samples left in the output buffer
+         */
+        uint8_t *symbol_dest(uint8_t *out, int room);
+
+        /**
+         *  \brief  Account for a symbol written at the position given by symbol_dest.
+         *
+         *  \param  out
+         *          current position in the output buffer
+         *  \param  room
+         *          number of samples left in the output buffer
+         *  \param  nsamples
+         *          number of samples of the symbol
+         *  \return The number of samples written to the output buffer
+         */
+        int symbol_done(uint8_t *out, int room, int nsamples);
+
      public:
-      DownModulate_impl(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words);
+      DownModulate_impl(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words,
+                        sample_format format, float full_scale);
       ~DownModulate_impl();
 
+      void set_max_latency(int max_samples);
+
       void forecast (int noutput_items, gr_vector_int &ninput_items_required);
 
       int general_work(int noutput_items,
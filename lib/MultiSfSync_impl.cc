@@ -0,0 +1,150 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <algorithm>
+#include "MultiSfSync_impl.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    static std::vector<int> output_sizes(const std::vector<uint8_t> &sf)
+    {
+        std::vector<int> sizes;
+        for (size_t i = 0; i < sf.size(); i++)
+            sizes.push_back((1u << sf[i]) * sizeof(gr_complex));
+        return sizes;
+    }
+
+    MultiSfSync::sptr
+    MultiSfSync::make(float samp_rate, uint32_t bandwidth, std::vector<uint8_t> sf, std::vector<uint16_t> sync_word)
+    {
+      return gnuradio::get_initial_sptr
+        (new MultiSfSync_impl(samp_rate, bandwidth, sf, sync_word));
+    }
+
+
+    /*
+     * The private constructor
+     */
+    MultiSfSync_impl::MultiSfSync_impl(float samp_rate, uint32_t bandwidth, std::vector<uint8_t> sf, std::vector<uint16_t> sync_word)
+      : gr::block("MultiSfSync",
+              gr::io_signature::make(1, 1, sizeof(gr_complex)),
+              gr::io_signature::makev(sf.size(), sf.size(), output_sizes(sf))),
+        m_telemetry([this](pmt::pmt_t msg) { message_port_pub(pmt::mp("telemetry"), msg); })
+    {
+      int max_window = 0;
+      for (size_t i = 0; i < sf.size(); i++) {
+          m_syncs.push_back(std::unique_ptr<frame_sync_engine>(new frame_sync_engine(samp_rate, bandwidth, sf[i], sync_word)));
+          //the alarm ID and its CRC, as FrameSync forwards them to ReceiveDown and Crc_verif
+          m_syncs[i]->set_symb_numb(1+2);
+          max_window = std::max(max_window, m_syncs[i]->window_len());
+      }
+      m_offsets.resize(sf.size(), 0);
+      //the engines all read the same input buffer, don't let the fast ones get too far ahead
+      m_max_lag = 2*max_window;
+
+      //the engines run in the same work call, they are a single producer for the ring
+      message_port_register_out(pmt::mp("telemetry"));
+      for (size_t i = 0; i < m_syncs.size(); i++)
+          m_syncs[i]->set_telemetry(&m_telemetry.ring());
+    }
+
+    /*
+     * Our virtual destructor.
+     */
+    MultiSfSync_impl::~MultiSfSync_impl()
+    {
+    }
+
+    void MultiSfSync_impl::set_squelch_threshold(float threshold_db)
+    {
+        for (size_t i = 0; i < m_syncs.size(); i++)
+            m_syncs[i]->set_squelch_threshold(threshold_db);
+    }
+
+    void MultiSfSync_impl::set_max_frames(int max_frames)
+    {
+        for (size_t i = 0; i < m_syncs.size(); i++)
+            m_syncs[i]->set_max_frames(max_frames);
+    }
+
+    bool MultiSfSync_impl::start()
+    {
+        m_telemetry.start();
+        return block::start();
+    }
+
+    bool MultiSfSync_impl::stop()
+    {
+        m_telemetry.stop();
+        return block::stop();
+    }
+
+    void
+    MultiSfSync_impl::forecast (int /*noutput_items*/, gr_vector_int &ninput_items_required)
+    {
+      /* <+forecast+> e.g. ninput_items_required[0] = noutput_items */
+      int required = 0;
+      for (size_t i = 0; i < m_syncs.size(); i++)
+          required = std::max(required, int(m_offsets[i] - nitems_read(0)) + m_syncs[i]->window_len());
+      ninput_items_required[0] = required;
+    }
+
+    int
+    MultiSfSync_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+      const gr_complex *in = (const gr_complex *) input_items[0];
+      uint64_t base = nitems_read(0);
+      int ninput = ninput_items[0];
+      uint64_t oldest = *std::min_element(m_offsets.begin(), m_offsets.end());
+
+      for (size_t k = 0; k < m_syncs.size(); k++) {
+          int start = m_offsets[k] - base;
+          int avail = std::min<int64_t>(ninput, oldest - base + m_max_lag + m_syncs[k]->window_len()) - start;
+          int consumed = 0;
+          int produced = 0;
+
+          m_frames.clear();
+          if (avail > 0)
+              produced = m_syncs[k]->work(&in[start], avail, (gr_complex *)output_items[k], noutput_items,
+                                          consumed, m_frames);
+          for (size_t i = 0; i < m_frames.size(); i++) {
+              pmt::pmt_t frame_info = pmt::make_dict();
+              frame_info = pmt::dict_add(frame_info,pmt::intern("cfo_int"), pmt::mp((long)m_frames[i].cfo_int));
+              add_item_tag(k, nitems_written(k)+m_frames[i].out_index, pmt::string_to_symbol("frame_info"),frame_info);
+          }
+          m_offsets[k] += consumed;
+          produce(k, produced);
+      }
+
+      consume_each(*std::min_element(m_offsets.begin(), m_offsets.end()) - base);
+      return WORK_CALLED_PRODUCE;
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,67 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_MULTISFSYNC_IMPL_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_MULTISFSYNC_IMPL_H
+
+#include <CounterClockwiseAlarms/MultiSfSync.h>
+#include <memory>
+#include "frame_sync_engine.h"
+#include "telemetry_publisher.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    class MultiSfSync_impl : public MultiSfSync
+    {
+     private:
+      std::vector<std::unique_ptr<frame_sync_engine> > m_syncs; ///< one synchronization engine per spreading factor
+      std::vector<uint64_t> m_offsets;    ///< absolute index of the next symbol window of each engine
+      std::vector<frame_start> m_frames;  ///< frames synchronized by an engine during the current work call
+      int m_max_lag;                      ///< maximum distance in samples between the most advanced and the oldest engine
+
+
+      telemetry_publisher m_telemetry;        ///< publishes the offsets of the frames of all the engines
+
+     public:
+      MultiSfSync_impl(float samp_rate, uint32_t bandwidth, std::vector<uint8_t> sf, std::vector<uint16_t> sync_word);
+      ~MultiSfSync_impl();
+
+      void set_squelch_threshold(float threshold_db);
+      void set_max_frames(int max_frames);
+
+      bool start();
+      bool stop();
+
+      // Where all the action really happens
+      void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+      int general_work(int noutput_items,
+           gr_vector_int &ninput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items);
+
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_MULTISFSYNC_IMPL_H */
+
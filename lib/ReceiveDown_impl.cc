@@ -22,7 +22,11 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include <CounterClockwiseAlarms/utilities.h>
 #include "ReceiveDown_impl.h"
 
 namespace gr {
@@ -42,17 +46,23 @@ namespace gr {
     ReceiveDown_impl::ReceiveDown_impl(uint8_t sf, bool impl_head)
       : gr::block("ReceiveDown",
               gr::io_signature::make(1, 1, (1u << sf)*sizeof(gr_complex)),
-              gr::io_signature::make(0, 1, sizeof(uint32_t)))
+              gr::io_signature::make2(0, 2, sizeof(uint32_t), sizeof(symbol_confidence)))
     {
       m_sf = sf;
 
       m_samples_per_symbol = (uint32_t)(1u << m_sf);
-      m_upchirp.resize(m_samples_per_symbol);
+      m_chirps = &chirp_table::get(m_sf);
       m_downchirp.resize(m_samples_per_symbol);
 
       // FFT demodulation preparations
-      m_fft.resize(m_samples_per_symbol);
-      m_dechirped.resize(m_samples_per_symbol);
+      m_demod = symbol_demodulator::make(m_sf);
+      m_mag.resize(m_samples_per_symbol);
+
+      // keys of the frame tags, interned once rather than for every symbol
+      m_frame_info_key = pmt::string_to_symbol("frame_info");
+      m_cfo_int_key = pmt::string_to_symbol("cfo_int");
+      m_error_key = pmt::string_to_symbol("error");
+      m_tags.reserve(8);
 
       set_tag_propagation_policy(TPP_DONT);
     }
@@ -68,45 +78,35 @@ namespace gr {
     ReceiveDown_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
     {
       /* <+forecast+> e.g. ninput_items_required[0] = noutput_items */
-       ninput_items_required[0] = 1;
+       ninput_items_required[0] = noutput_items;
     }
 
-    int32_t ReceiveDown_impl::get_symbol_val(const gr_complex *samples) {
-        float m_fft_mag[m_samples_per_symbol];
-        float rec_en=0;
-        kiss_fft_cfg cfg =  kiss_fft_alloc(m_samples_per_symbol,0,0,0);
-        kiss_fft_cpx *cx_in = new kiss_fft_cpx[m_samples_per_symbol];
-        kiss_fft_cpx *cx_out = new kiss_fft_cpx[m_samples_per_symbol];
-
-        // Multiply with ideal upchirp
-        volk_32fc_x2_multiply_32fc(&m_dechirped[0],samples,&m_upchirp[0],m_samples_per_symbol);
-        for (int i = 0; i < m_samples_per_symbol; i++) {
-          cx_in[i].r = m_dechirped[i].real();
-          cx_in[i].i = m_dechirped[i].imag();
-        }
-        //do the FFT
-        kiss_fft(cfg,cx_in,cx_out);
-        // Get magnitude
-        for (uint32_t i = 0u; i < m_samples_per_symbol; i++) {
-            m_fft_mag[i] = cx_out[i].r*cx_out[i].r+cx_out[i].i*cx_out[i].i;
-            rec_en+=m_fft_mag[i];
-        }
-
-        free(cfg);
-        delete[] cx_in;
-        delete[] cx_out;
-        // Return argmax
+    int32_t ReceiveDown_impl::get_symbol_val(const gr_complex *samples, demod_result &res) {
+        // Multiply with ideal downchirp, FFT and argmax in one go
+        m_demod->demod(samples, &m_downchirp[0], res);
+        return res.bin;
+    }
 
-        int idx = std::max_element(m_fft_mag, m_fft_mag + m_samples_per_symbol) - m_fft_mag;
-       
-        return (idx);
+    void ReceiveDown_impl::get_confidence(const demod_result &res, symbol_confidence &conf) {
+        volk_32fc_magnitude_squared_32f(&m_mag[0], m_demod->spectrum(), m_samples_per_symbol);
+        for (int k = 0; k < symbol_confidence::top_k; k++) {
+            uint32_t peak = k ? 0 : res.bin;
+            if(k)
+                volk_32f_index_max_32u(&peak, &m_mag[0], m_samples_per_symbol);
+            conf.top_bin[k] = peak;
+            conf.top_energy[k] = m_mag[peak];
+            // a symbol between 2 bins leaks into the bins next to its peak
+            for (int i = -1; i <= 1; i++)
+                m_mag[lora_sdr::mod((int32_t)peak+i, m_samples_per_symbol)] = 0;
+        }
+        conf.peak_ratio = conf.top_energy[1] > 0 ? conf.top_energy[0]/conf.top_energy[1] : INFINITY;
+        float noise = res.total_energy-res.peak_energy;
+        conf.snr_db = noise > 0 ? 10*log10f(res.peak_energy/noise) : INFINITY;
     }
     void ReceiveDown_impl::new_frame_handler(int cfo_int){
-        //create downchirp taking CFOint into account
-        build_upchirp(&m_upchirp[0],mod(cfo_int,m_samples_per_symbol),m_sf);
-        volk_32fc_conjugate_32fc(&m_downchirp[0],&m_upchirp[0],m_samples_per_symbol);
-        output.clear();
-      
+        //create downchirp taking CFOint into account, conjugating the upchirp in place
+        m_chirps->upchirp(&m_downchirp[0],lora_sdr::mod(cfo_int,m_samples_per_symbol));
+        volk_32fc_conjugate_32fc(&m_downchirp[0],&m_downchirp[0],m_samples_per_symbol);
     };
     int
     ReceiveDown_impl::general_work (int noutput_items,
@@ -116,32 +116,35 @@ namespace gr {
     {
       const gr_complex *in = (const gr_complex *) input_items[0];
       uint32_t *out = (uint32_t *) output_items[0];
-      
-      int to_output=0;
-      std::vector<tag_t> tags;
-      get_tags_in_window(tags,0,0,1,pmt::string_to_symbol("frame_info"));
-
-      if(tags.size()){
-        pmt::pmt_t err = pmt::string_to_symbol("error");
-        int cfo_int = pmt::to_long (pmt::dict_ref(tags[0].value,pmt::string_to_symbol("cfo_int"),err));
-        new_frame_handler(cfo_int);
-        tags[0].offset = nitems_written(0);
-        add_item_tag(0, tags[0]); //8 LoRa symbols in the header
-      }      
-      //shift by -1 and use reduce rate if first block (header)
-      output.push_back(mod(get_symbol_val(in)-1,(1<<m_sf)));
-      block_size = 1;
-      if((output.size() == block_size)){
-          memcpy(&out[0],&output[0],block_size*sizeof(uint32_t));
-          output.clear();
-          to_output = block_size;
+      symbol_confidence *conf = output_items.size() > 1 ? (symbol_confidence *) output_items[1] : 0;
+
+      //one symbol out per symbol in, demodulate all of them at once
+      int nitems = std::min(ninput_items[0], noutput_items);
+      uint64_t nread = nitems_read(0);
+      get_tags_in_window(m_tags,0,0,nitems,m_frame_info_key);
+      std::sort(m_tags.begin(), m_tags.end(), tag_t::offset_compare);
+      size_t tag_idx = 0;
+
+      for (int i = 0; i < nitems; i++) {
+          //a new frame starts with this symbol
+          while(tag_idx < m_tags.size() && m_tags[tag_idx].offset == nread+i){
+              tag_t &tag = m_tags[tag_idx++];
+              int cfo_int = pmt::to_long (pmt::dict_ref(tag.value,m_cfo_int_key,m_error_key));
+              new_frame_handler(cfo_int);
+              tag.offset = nitems_written(0)+i;
+              add_item_tag(0, tag); //8 LoRa symbols in the header
+          }
+          //DownModulate sends the symbol values as they are
+          demod_result res;
+          out[i] = get_symbol_val(&in[i*m_samples_per_symbol], res);
+          //the confidence is only measured when someone reads it
+          if(conf)
+              get_confidence(res, conf[i]);
       }
-      else
-          to_output = 0;
-      consume_each(1);
+      consume_each(nitems);
 
       // Tell runtime system how many output items we produced.
-      return to_output;
+      return nitems;
     }
 
   } /* namespace CounterClockwiseAlarms */
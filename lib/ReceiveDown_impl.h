@@ -22,6 +22,9 @@
 #define INCLUDED_COUNTERCLOCKWISEALARMS_RECEIVEDOWN_IMPL_H
 
 #include <CounterClockwiseAlarms/ReceiveDown.h>
+#include <CounterClockwiseAlarms/symbol_confidence.h>
+#include "chirp_table.h"
+#include "symbol_demod.h"
 
 namespace gr {
   namespace CounterClockwiseAlarms {
@@ -30,21 +33,19 @@ namespace gr {
     {
      private:
       uint8_t m_sf;           ///< Spreading factor
-      uint8_t m_cr;           ///< Coding rate
 
       uint32_t m_samples_per_symbol;  ///< Number of samples received per lora symbols
-      int CFOint; ///< integer part of the CFO
 
       // variable used to perform the FFT demodulation
-      std::vector<gr_complex> m_upchirp;   ///< Reference upchirp
+      const chirp_table *m_chirps;         ///< Shared table of the modulated chirps
       std::vector<gr_complex> m_downchirp; ///< Reference downchirp
-      std::vector<gr_complex> m_dechirped; ///< Dechirped symbol
-      std::vector<gr_complex> m_fft;       ///< Result of the FFT
+      std::unique_ptr<symbol_demodulator> m_demod; ///< Demodulation kernel of the spreading factor
+      std::vector<float> m_mag;            ///< Energy of the bins of the last spectrum, for the confidence
 
-
-      std::vector<uint32_t> output;   ///< Stores the value to be outputted once a full bloc has been received
-      bool is_header;                  ///< Indicate that the first block hasn't been fully received
-      uint8_t block_size;             ///< The number of lora symbol in one block
+      std::vector<tag_t> m_tags;      ///< Frame tags of the symbols of one call, kept to reuse its storage
+      pmt::pmt_t m_frame_info_key;    ///< Key of the tags starting a frame
+      pmt::pmt_t m_cfo_int_key;       ///< Key of the integer CFO in the frame tags
+      pmt::pmt_t m_error_key;         ///< Value returned for a missing key
 
 
       #ifdef GRLORA_MEASUREMENTS
@@ -59,8 +60,20 @@ namespace gr {
        *
        *  \param  samples
        *          The pointer to the symbol beginning.
+       *  \param  res
+       *          The demodulation result
+       */
+      int32_t get_symbol_val(const gr_complex *samples, demod_result &res);
+
+      /**
+       *  \brief  Measure the confidence of the symbol demodulated last.
+       *
+       *  \param  res
+       *          The demodulation result of the symbol
+       *  \param  conf
+       *          The confidence record to fill
        */
-      int32_t get_symbol_val(const gr_complex *samples);
+      void get_confidence(const demod_result &res, symbol_confidence &conf);
 
       /**
        *  \brief  Reset the block variables when a new lora packet needs to be decoded.
@@ -0,0 +1,171 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "chirp_nco.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    chirp_nco::chirp_nco(uint8_t sf, uint32_t samp_rate, uint32_t bw)
+      : m_number_of_bins(1u << sf), m_samp_rate(samp_rate), m_bw(bw),
+        m_ticks(0), m_next_sample(0), m_phase(0), m_format(SAMPLE_FC32), m_out_scale(1)
+    {
+    }
+
+    void chirp_nco::set_output_format(sample_format format, float full_scale)
+    {
+        m_format = format;
+        m_out_scale = full_scale > 0 ? full_scale : default_full_scale(format);
+    }
+
+    template <typename T>
+    static inline void store(T *out, float v, float scale)
+    {
+        v = std::min(std::max(v * scale, (float)std::numeric_limits<T>::min()), (float)std::numeric_limits<T>::max());
+        *out = (T)lrintf(v);
+    }
+
+    static inline void store(float *out, float v, float)
+    {
+        *out = v;
+    }
+
+    int chirp_nco::samples(uint64_t quarters) const
+    {
+        // sample n is at tick n*4*bw, a quarter-symbol lasts 2^sf*samp_rate ticks
+        uint64_t ticks = quarters * m_number_of_bins * m_samp_rate;
+        uint64_t tick_per_sample = 4 * (uint64_t)m_bw;
+        return (ticks + tick_per_sample - 1) / tick_per_sample;
+    }
+
+    int chirp_nco::advance(int quarters, double &offset)
+    {
+        uint64_t tick_per_sample = 4 * (uint64_t)m_bw;
+        uint64_t end = m_ticks + (uint64_t)quarters * m_number_of_bins * m_samp_rate;
+        uint64_t end_sample = (end + tick_per_sample - 1) / tick_per_sample;
+        offset = double(m_next_sample * tick_per_sample - m_ticks) / (double(tick_per_sample) * m_samp_rate);
+        int n = end_sample - m_next_sample;
+        m_ticks = end;
+        m_next_sample = end_sample;
+        return n;
+    }
+
+    void chirp_nco::segment(void *out, int n, double offset, double duration, double freq, double rate)
+    {
+        if (m_format == SAMPLE_SC16)
+            write_segment(static_cast<int16_t *>(out), n, offset, duration, freq, rate);
+        else if (m_format == SAMPLE_SC8)
+            write_segment(static_cast<int8_t *>(out), n, offset, duration, freq, rate);
+        else
+            write_segment(static_cast<float *>(out), n, offset, duration, freq, rate);
+    }
+
+    template <typename S>
+    void chirp_nco::write_segment(S *o, int n, double offset, double duration, double freq, double rate)
+    {
+        const int L = 8;
+        // the float rotations drift in amplitude and phase, the lanes are set again from the
+        // exact phase every K samples
+        const int K = 64 * L;
+        double T = 1.0 / m_samp_rate;
+        // lane l holds the samples l, l+L, l+2L... its phase steps by w, whose phase steps by r
+        float pr[L], pi[L], wr[L], wi[L];
+        double chirp_step = 2 * M_PI * rate * (L * T) * (L * T);
+        float rr = cos(chirp_step), ri = sin(chirp_step);
+
+        float scale = m_out_scale;
+        int i = 0;
+        for (; i + L <= n; i += L) {
+            if (i % K == 0) {
+                for (int l = 0; l < L; l++) {
+                    double t = offset + (i + l) * T;
+                    double phase = m_phase + 2 * M_PI * (freq * t + rate / 2 * t * t);
+                    double step = 2 * M_PI * ((freq + rate * t) * L * T + rate / 2 * (L * T) * (L * T));
+                    pr[l] = cos(phase);
+                    pi[l] = sin(phase);
+                    wr[l] = cos(step);
+                    wi[l] = sin(step);
+                }
+            }
+            for (int l = 0; l < L; l++) {
+                store(&o[2 * (i + l)], pr[l], scale);
+                store(&o[2 * (i + l) + 1], pi[l], scale);
+                float npr = pr[l] * wr[l] - pi[l] * wi[l];
+                float npi = pr[l] * wi[l] + pi[l] * wr[l];
+                float nwr = wr[l] * rr - wi[l] * ri;
+                float nwi = wr[l] * ri + wi[l] * rr;
+                pr[l] = npr;
+                pi[l] = npi;
+                wr[l] = nwr;
+                wi[l] = nwi;
+            }
+        }
+        // the last samples, fewer than L, are computed directly
+        for (; i < n; i++) {
+            double t = offset + i * T;
+            double phase = m_phase + 2 * M_PI * (freq * t + rate / 2 * t * t);
+            store(&o[2 * i], (float)cos(phase), scale);
+            store(&o[2 * i + 1], (float)sin(phase), scale);
+        }
+
+        // the next segment starts where this one ends, not at its last sample
+        m_phase = fmod(m_phase + 2 * M_PI * (freq * duration + rate / 2 * duration * duration), 2 * M_PI);
+    }
+
+    int chirp_nco::upchirp(void *out, uint32_t id, int quarters)
+    {
+        id &= m_number_of_bins - 1;
+        double offset;
+        int n = advance(quarters, offset);
+        double bw = m_bw;
+        double rate = bw * bw / m_number_of_bins;
+        double duration = quarters * m_number_of_bins / (4 * bw);
+        // the frequency folds from bw/2 to -bw/2 after (2^sf-id)/bw seconds
+        double fold = std::min(double(m_number_of_bins - id) / bw, duration);
+        int n_fold = std::max(0.0, std::min<double>(n, ceil((fold - offset) * m_samp_rate)));
+        segment(out, n_fold, offset, fold, bw * id / m_number_of_bins - bw / 2, rate);
+        if (fold < duration)
+            segment(static_cast<uint8_t *>(out) + n_fold * output_size(), n - n_fold, offset + double(n_fold) / m_samp_rate - fold, duration - fold, -bw / 2, rate);
+        return n;
+    }
+
+    int chirp_nco::downchirp(void *out, int quarters)
+    {
+        double offset;
+        int n = advance(quarters, offset);
+        double bw = m_bw;
+        segment(out, n, offset, quarters * m_number_of_bins / (4 * bw), bw / 2, -bw * bw / m_number_of_bins);
+        return n;
+    }
+
+    int chirp_nco::zeros(void *out, int quarters)
+    {
+        double offset;
+        int n = advance(quarters, offset);
+        memset(out, 0, n * output_size());
+        return n;
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
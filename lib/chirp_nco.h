@@ -0,0 +1,155 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_CHIRP_NCO_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_CHIRP_NCO_H
+
+#include <cstdint>
+#include <CounterClockwiseAlarms/dsp_complex.h>
+#include <CounterClockwiseAlarms/sample_format.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Chirp synthesizer for any sampling rate, phase continuous from one symbol to the next.
+     *
+     *  The sampling rate needs not be a multiple of the bandwidth: the symbol boundaries are
+     *  kept exactly, as integers, so a symbol spans floor or ceil of 2^sf*samp_rate/bw samples
+     *  and frames never drift. The phase and the frequency are carried from sample to sample
+     *  by complex rotations, 8 interleaved lanes at a time, with trigonometry only every 512
+     *  samples to keep the float rotations from drifting. Durations are in quarters of a symbol, for the 0.25
+     *  downchirp of the preamble. Integer output formats are written straight from the lanes,
+     *  scaled and saturated, without a float copy of the chirp.
+     */
+    class chirp_nco
+    {
+     public:
+      /**
+       *  \param  sf
+       *          The spreading factor
+       *  \param  samp_rate
+       *          The sampling rate
+       *  \param  bw
+       *          The bandwidth, at most samp_rate
+       */
+      chirp_nco(uint8_t sf, uint32_t samp_rate, uint32_t bw);
+
+      /**
+       *  \brief  Restart the symbol boundaries at the next sample, for a new frame. The phase goes on.
+       */
+      void restart() { m_ticks = 0; m_next_sample = 0; }
+
+      /**
+       *  \brief  Set the format of the output samples, SAMPLE_FC32 by default
+       *
+       *  \param  full_scale
+       *          The integer value of an amplitude of 1.0, 0 for default_full_scale(format).
+       *          Samples beyond the integer range saturate.
+       */
+      void set_output_format(sample_format format, float full_scale = 0);
+
+      /**
+       *  \brief  Size in bytes of an output sample
+       */
+      size_t output_size() const { return sample_size(m_format); }
+
+      /**
+       *  \brief  Number of samples of quarters quarter-symbols following restart()
+       */
+      int samples(uint64_t quarters) const;
+
+      /**
+       *  \brief  Maximum number of samples written by a call spanning quarters quarter-symbols,
+       *          wherever the call starts
+       */
+      int max_samples(int quarters = 4) const { return samples(quarters); }
+
+      /**
+       *  \brief  Write the upchirp modulated by id
+       *
+       *  \param  out
+       *          The output, max_samples(quarters) samples long, in the output format
+       *  \param  id
+       *          The symbol value, taken modulo 2^sf
+       *  \param  quarters
+       *          The duration, in quarters of a symbol
+       *  \return The number of samples written
+       */
+      int upchirp(void *out, uint32_t id, int quarters = 4);
+
+      /**
+       *  \brief  Write the reference downchirp, same as upchirp()
+       */
+      int downchirp(void *out, int quarters = 4);
+
+      /**
+       *  \brief  Write zeros for the given duration, same as upchirp()
+       */
+      int zeros(void *out, int quarters = 4);
+
+     private:
+      /**
+       *  \brief  Advance the time base by quarters quarter-symbols
+       *
+       *  \param  offset
+       *          Gets the time from the symbol start to its first sample, in seconds
+       *  \return The number of samples of the symbol
+       */
+      int advance(int quarters, double &offset);
+
+      /**
+       *  \brief  Write the samples of a linear chirp, starting at the current phase
+       *
+       *  \param  out
+       *          The output
+       *  \param  n
+       *          The number of samples
+       *  \param  offset
+       *          The time from the segment start to the first sample, in seconds
+       *  \param  duration
+       *          The duration of the segment, in seconds
+       *  \param  freq
+       *          The frequency at the segment start, in Hz
+       *  \param  rate
+       *          The frequency slope, in Hz/s
+       */
+      void segment(void *out, int n, double offset, double duration, double freq, double rate);
+
+      /**
+       *  \brief  segment() writing the interleaved components of the samples as S
+       */
+      template <typename S>
+      void write_segment(S *out, int n, double offset, double duration, double freq, double rate);
+
+      uint32_t m_number_of_bins;  ///< Number of symbol values
+      uint32_t m_samp_rate;       ///< Sampling rate
+      uint32_t m_bw;              ///< Bandwidth
+      uint64_t m_ticks;           ///< Time since restart(), in units of 1/(4*bw*samp_rate) s
+      uint64_t m_next_sample;     ///< Index, since restart(), of the next sample to write
+      double m_phase;             ///< Phase at the current time, in radians
+      sample_format m_format;     ///< Format of the output samples
+      float m_out_scale;          ///< Integer value of an amplitude of 1.0
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_CHIRP_NCO_H */
@@ -0,0 +1,72 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "chirp_table.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    const chirp_table &chirp_table::get(uint8_t sf, uint32_t os_factor)
+    {
+        static std::mutex mutex;
+        static std::map<std::pair<uint8_t, uint32_t>, std::shared_ptr<chirp_table> > tables;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<chirp_table> &table = tables[std::make_pair(sf, os_factor)];
+        if (!table)
+            table.reset(new chirp_table(sf, os_factor));
+        return *table;
+    }
+
+    chirp_table::chirp_table(uint8_t sf, uint32_t os_factor)
+      : m_sf(sf),
+        m_os_factor(os_factor),
+        m_number_of_bins(1u << sf),
+        m_samples_per_symbol((1u << sf) * os_factor)
+    {
+        m_upchirp.resize(2 * m_samples_per_symbol);
+        m_downchirp.resize(m_samples_per_symbol);
+        m_phase.resize(m_number_of_bins);
+
+        lora_sdr::build_ref_chirps(&m_upchirp[0], &m_downchirp[0], m_sf, m_os_factor);
+        memcpy(&m_upchirp[m_samples_per_symbol], &m_upchirp[0], m_samples_per_symbol * sizeof(gr_complex));
+
+        // build_upchirp always starts with a phase of 0, so the constant term of each symbol
+        // is the conjugate of the first sample of its rotation
+        for (uint32_t id = 0; id < m_number_of_bins; id++)
+            m_phase[id] = std::conj(m_upchirp[id * m_os_factor]);
+    }
+
+    void chirp_table::upchirp(gr_complex *chirp, uint32_t id) const
+    {
+        id &= m_number_of_bins - 1;
+        volk_32fc_s32fc_multiply_32fc(chirp, &m_upchirp[id * m_os_factor], m_phase[id], m_samples_per_symbol);
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
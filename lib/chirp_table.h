@@ -0,0 +1,101 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_CHIRP_TABLE_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_CHIRP_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include <CounterClockwiseAlarms/dsp_complex.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Precomputed chirps for one (sf, os_factor) pair, shared by all the blocks.
+     *
+     *  The upchirp modulated by id is the reference upchirp cyclically shifted by id*os_factor
+     *  samples, times a constant phase. The table stores two periods of the reference upchirp
+     *  so every modulated symbol is a contiguous slice of it, and the per-symbol phase term.
+     *  Building a symbol is then a single complex scaling pass, without any trigonometry.
+     */
+    class chirp_table
+    {
+     public:
+      /**
+       *  \brief  Return the table for the given parameters, building it on first use.
+       *
+       *  \param  sf
+       *          The spreading factor
+       *  \param  os_factor
+       *          The oversampling factor
+       */
+      static const chirp_table &get(uint8_t sf, uint32_t os_factor = 1);
+
+      uint8_t sf() const { return m_sf; }
+      uint32_t os_factor() const { return m_os_factor; }
+      uint32_t samples_per_symbol() const { return m_samples_per_symbol; }
+
+      /**
+       *  \brief  Reference upchirp (id 0), samples_per_symbol() long.
+       */
+      const gr_complex *upchirp() const { return &m_upchirp[0]; }
+
+      /**
+       *  \brief  Reference downchirp, samples_per_symbol() long.
+       */
+      const gr_complex *downchirp() const { return &m_downchirp[0]; }
+
+      /**
+       *  \brief  Upchirp modulated by id, without its constant phase term. Suited to non
+       *          coherent processing where the absolute phase of the symbol doesn't matter.
+       *
+       *  \param  id
+       *          The symbol value, taken modulo 2^sf
+       */
+      const gr_complex *rotated_upchirp(uint32_t id) const
+      { return &m_upchirp[(id & (m_number_of_bins - 1)) * m_os_factor]; }
+
+      /**
+       *  \brief  Write the upchirp modulated by id, identical to build_upchirp(chirp, id, sf, os_factor).
+       *
+       *  \param  chirp
+       *          The output, samples_per_symbol() long
+       *  \param  id
+       *          The symbol value, taken modulo 2^sf
+       */
+      void upchirp(gr_complex *chirp, uint32_t id) const;
+
+     private:
+      chirp_table(uint8_t sf, uint32_t os_factor);
+
+      uint8_t m_sf;                        ///< Spreading factor
+      uint32_t m_os_factor;                ///< Oversampling factor
+      uint32_t m_number_of_bins;           ///< Number of symbol values
+      uint32_t m_samples_per_symbol;       ///< Number of samples per chirp
+      std::vector<gr_complex> m_upchirp;   ///< Two periods of the reference upchirp
+      std::vector<gr_complex> m_downchirp; ///< Reference downchirp
+      std::vector<gr_complex> m_phase;     ///< Constant phase term of each symbol value
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_CHIRP_TABLE_H */
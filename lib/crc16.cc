@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "crc16.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    namespace {
+
+      struct crc16_tables
+      {
+        uint16_t t[8][256];
+
+        crc16_tables()
+        {
+            for (int i = 0; i < 256; i++) {
+                uint16_t crc = i;
+                for (int j = 0; j < 8; j++)
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+                t[0][i] = crc;
+            }
+            for (int k = 1; k < 8; k++)
+                for (int i = 0; i < 256; i++)
+                    t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xff];
+        }
+      };
+
+      // built before main, update() is then safe from any thread
+      const crc16_tables s_tables;
+
+    } // anonymous namespace
+
+    const uint16_t *crc16::table(int k)
+    {
+        return s_tables.t[k];
+    }
+
+    void crc16::update(const uint8_t *data, size_t len)
+    {
+        const uint16_t (*t)[256] = s_tables.t;
+        uint32_t crc = m_crc;
+        // the CRC is xored into the first 2 bytes, each byte then goes through the table of
+        // the number of bytes following it in the block
+        for (; len >= 8; len -= 8, data += 8) {
+            uint32_t lo = (data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24) ^ crc;
+            uint32_t hi = data[4] | data[5] << 8 | data[6] << 16 | (uint32_t)data[7] << 24;
+            crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        }
+        for (; len; len--, data++)
+            crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xff];
+        m_crc = crc;
+    }
+
+    uint16_t crc16::compute(const uint8_t *data, size_t len)
+    {
+        crc16 crc;
+        crc.update(data, len);
+        return crc.value();
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_CRC16_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_CRC16_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  CRC-16/MODBUS (reflected poly 0xA001, init 0xFFFF, no final xor), computed 8 bytes at a time.
+     *
+     *  The data can be fed in pieces, across work calls. The CRC is sent low byte first, and
+     *  the CRC of data followed by its CRC sent that way is 0.
+     */
+    class crc16
+    {
+     public:
+      crc16() : m_crc(0xffff) {}
+
+      /**
+       *  \brief  Start a new message
+       */
+      void reset() { m_crc = 0xffff; }
+
+      /**
+       *  \brief  Add bytes to the message
+       *
+       *  \param  data
+       *          The pointer to the bytes
+       *  \param  len
+       *          The number of bytes
+       */
+      void update(const uint8_t *data, size_t len);
+
+      /**
+       *  \brief  Add one byte to the message
+       */
+      void update(uint8_t byte) { m_crc = (m_crc >> 8) ^ table(0)[(m_crc ^ byte) & 0xff]; }
+
+      /**
+       *  \brief  CRC of the bytes added since the last reset
+       */
+      uint16_t value() const { return m_crc; }
+
+      /**
+       *  \brief  CRC of a whole message
+       */
+      static uint16_t compute(const uint8_t *data, size_t len);
+
+     private:
+      /**
+       *  \brief  Table k gives the CRC contribution of a byte followed by k zero bytes
+       */
+      static const uint16_t *table(int k);
+
+      uint16_t m_crc; ///< CRC of the bytes added so far
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_CRC16_H */
@@ -22,6 +22,7 @@
 #include "config.h"
 #endif
 
+#include <cstring>
 #include <gnuradio/io_signature.h>
 #include "crcAppend_impl.h"
 
@@ -41,11 +42,18 @@ namespace gr {
      */
     crcAppend_impl::crcAppend_impl(bool has_crc)
       : gr::block("crcAppend",
-              gr::io_signature::make(1, 1, sizeof(uint8_t)),
-              gr::io_signature::make(1, 1, sizeof(uint32_t)))
+              gr::io_signature::make(0, 1, sizeof(uint8_t)),
+              gr::io_signature::make(0, 1, sizeof(uint32_t)))
     {
       m_has_crc = has_crc;
+      m_frame_len = 0;
+      m_cnt = 0;
       set_tag_propagation_policy(TPP_DONT);
+
+      // PDU mode: a whole frame per message, the CRC appended in one go
+      message_port_register_in(pmt::mp("pdu"));
+      message_port_register_out(pmt::mp("pdu"));
+      set_msg_handler(pmt::mp("pdu"), boost::bind(&crcAppend_impl::pdu_handler, this, _1));
     }
 
     /*
@@ -56,28 +64,32 @@ namespace gr {
     }
 
 
-    unsigned int Calculate_crc16(std::vector<uint8_t> DAT, unsigned int length);
+    void
+    crcAppend_impl::pdu_handler(pmt::pmt_t msg)
     {
-        unsigned int CRC = 0xffff;
-        unsigned char i;
-        unsigned char j;
-        for (i = 0; i < length; i++)
-        {
-            CRC = CRC ^ DAT[i];
-            for(j = 0; j < 8;j++){
-                if(CRC & 0x01){
-                    CRC = CRC >> 1;
-                    CRC = CRC ^ 0xA001;
-                }else{
-                    CRC = CRC >> 1;
-                }
-                
-            }
-        }
-        return CRC;
+      if (!pmt::is_pair(msg) || !pmt::is_u8vector(pmt::cdr(msg)))
+      {
+          std::cerr << "[crcAppend] WARNING : PDU expected, message dropped\n";
+          return;
+      }
+      size_t len;
+      const uint8_t *payload = pmt::u8vector_elements(pmt::cdr(msg), len);
+      if (!m_has_crc)
+      {
+          message_port_pub(pmt::mp("pdu"), msg);
+          return;
+      }
+      pmt::pmt_t frame = pmt::make_u8vector(len + 2, 0);
+      size_t frame_len;
+      uint8_t *out = pmt::u8vector_writable_elements(frame, frame_len);
+      memcpy(out, payload, len);
+      //low byte first, as on the stream
+      uint16_t crc = crc16::compute(payload, len);
+      out[len] = crc & 0xff;
+      out[len+1] = crc >> 8;
+      message_port_pub(pmt::mp("pdu"), pmt::cons(pmt::car(msg), frame));
     }
 
-
     void
     crcAppend_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
     {
@@ -95,7 +107,7 @@ namespace gr {
       uint32_t *out = (uint32_t *) output_items[0];
 
       int nitems_to_output = 0;
-      noutput_items = std::max(0, noutput_items - 1);//take margin to output CRC
+      noutput_items = std::max(0, noutput_items - 2);//take margin to output CRC
       int nitems_to_process = std::min(ninput_items[0], noutput_items);
 
       // read tags
@@ -113,39 +125,37 @@ namespace gr {
               {
                   nitems_to_process = std::min(tags[1].offset - tags[0].offset, (uint64_t)noutput_items);
               }
-              std::string str = pmt::symbol_to_string(tags[0].value);
-              std::copy(str.begin(), str.end(), std::back_inserter(m_payload));
               //pass tags downstream
               get_tags_in_window(tags, 0, 0, ninput_items[0], pmt::string_to_symbol("frame_len"));
               m_frame_len = pmt::to_long(tags[0].value);
               tags[0].offset = nitems_written(0);
-              tags[0].value = pmt::from_long(m_frame_len + (m_has_crc ? 4 : 0));
+              tags[0].value = pmt::from_long(m_frame_len + (m_has_crc ? 2 : 0));
 
               if (nitems_to_process)
                   add_item_tag(0, tags[0]);
 
               m_cnt = 0;
+              m_crc.reset();
           }
       }
+      //stop at the frame end so that the CRC goes right after it
+      if (m_cnt < m_frame_len)
+          nitems_to_process = std::min(nitems_to_process, m_frame_len - m_cnt);
       if (!nitems_to_process)
       {
           return 0;
       }
       m_cnt += nitems_to_process;
+      //the CRC follows the bytes as they pass, the frame may span several calls
+      if (m_has_crc)
+          m_crc.update(in, nitems_to_process);
       if (m_has_crc && m_cnt == m_frame_len && nitems_to_process)
-      { //append the CRC to the payload
-          unsigned int crc = 0x0000;
-          m_payload_len = m_payload.size();
-          //calculate CRC on the data bytes using Poly=1021 Init=0000
-          Calculate_crc16(m_payload,m_payload_len);
-          unsigned char first = (value >> 8) & 0xff;
-	        unsigned char second = value & 0xff; 
-          //Place the CRC in the correct output nibble
-          out[nitems_to_process] = second;
-          out[nitems_to_process+1] = first;
+      { //append the CRC to the payload, low byte first
+          uint16_t crc = m_crc.value();
+          out[nitems_to_process] = crc & 0xff;
+          out[nitems_to_process+1] = crc >> 8;
 
           nitems_to_output = nitems_to_process + 2;
-          m_payload.clear();
       }
       else
       {
@@ -22,6 +22,7 @@
 #define INCLUDED_COUNTERCLOCKWISEALARMS_CRCAPPEND_IMPL_H
 
 #include <CounterClockwiseAlarms/crcAppend.h>
+#include "crc16.h"
 
 namespace gr {
   namespace CounterClockwiseAlarms {
@@ -30,10 +31,14 @@ namespace gr {
     {
      private:
       bool m_has_crc;
-      std::vector<uint8_t> m_payload; 
-      uint8_t m_payload_len;
-      int m_frame_len;
-      unsigned int Caculate_crc16(std::vector<uint8_t> DAT, unsigned int length);
+      int m_frame_len;      ///< Number of payload bytes of the current frame
+      int m_cnt;            ///< Number of payload bytes of the current frame already processed
+      crc16 m_crc;          ///< CRC of the payload bytes processed so far
+
+      /**
+       *  \brief  Append the CRC to the payload of a PDU and publish it.
+       */
+      void pdu_handler(pmt::pmt_t msg);
      public:
       crcAppend_impl(bool has_crc);
       ~crcAppend_impl();
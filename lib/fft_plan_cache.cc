@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <stdexcept>
+#include <volk/volk.h>
+#include "fft_plan_cache.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    fft_plan_cache &fft_plan_cache::instance()
+    {
+        static fft_plan_cache cache;
+        return cache;
+    }
+
+    kiss_fft_cfg fft_plan_cache::get(uint32_t nfft, bool inverse, fft_backend backend)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        plan_key key(nfft, inverse, backend);
+        std::map<plan_key, kiss_fft_cfg>::iterator it = m_plans.find(key);
+        if (it != m_plans.end())
+            return it->second;
+
+        kiss_fft_cfg cfg = kiss_fft_alloc(nfft, inverse, 0, 0);
+        if (!cfg)
+            throw std::runtime_error("fft_plan_cache: unable to create the FFT plan");
+        m_plans[key] = cfg;
+        return cfg;
+    }
+
+    fft_plan_cache::~fft_plan_cache()
+    {
+        for (std::map<plan_key, kiss_fft_cfg>::iterator it = m_plans.begin(); it != m_plans.end(); ++it)
+            free(it->second);
+    }
+
+    fft_buffer::fft_buffer(uint32_t size)
+      : m_data(0), m_size(0)
+    {
+        resize(size);
+    }
+
+    fft_buffer::~fft_buffer()
+    {
+        volk_free(m_data);
+    }
+
+    void fft_buffer::resize(uint32_t size)
+    {
+        volk_free(m_data);
+        m_data = 0;
+        m_size = size;
+        if (size)
+            m_data = (kiss_fft_cpx *)volk_malloc(size * sizeof(kiss_fft_cpx), volk_get_alignment());
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,106 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_FFT_PLAN_CACHE_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_FFT_PLAN_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include "kiss_fft.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    enum fft_backend {
+        FFT_BACKEND_KISS ///< kiss_fft, the only backend compiled in for now
+    };
+
+    /**
+     *  \brief  Process-wide registry of FFT plans keyed by (size, direction, backend).
+     *
+     *  Plans are created on first request and live until the process exits. kiss_fft only
+     *  reads its configuration while transforming, so the returned plan can be used by
+     *  several blocks and threads at the same time. Blocks should fetch their plans once
+     *  in the constructor and keep the pointer, the lookup itself takes a lock.
+     */
+    class fft_plan_cache
+    {
+     public:
+      static fft_plan_cache &instance();
+
+      /**
+       *  \brief  Return the plan for the given transform, creating it if needed.
+       *
+       *  \param  nfft
+       *          The FFT size
+       *  \param  inverse
+       *          Use the inverse transform
+       *  \param  backend
+       *          The FFT implementation
+       */
+      kiss_fft_cfg get(uint32_t nfft, bool inverse = false, fft_backend backend = FFT_BACKEND_KISS);
+
+      ~fft_plan_cache();
+
+     private:
+      typedef std::tuple<uint32_t, bool, fft_backend> plan_key;
+
+      fft_plan_cache() {}
+      fft_plan_cache(const fft_plan_cache &);
+      fft_plan_cache &operator=(const fft_plan_cache &);
+
+      std::mutex m_mutex;                       ///< protects m_plans
+      std::map<plan_key, kiss_fft_cfg> m_plans; ///< all the plans created so far
+    };
+
+    /**
+     *  \brief  Aligned FFT scratch buffer, owned by a single block instance.
+     */
+    class fft_buffer
+    {
+     public:
+      explicit fft_buffer(uint32_t size = 0);
+      ~fft_buffer();
+
+      /**
+       *  \brief  (Re)allocate the buffer. The previous content is lost.
+       */
+      void resize(uint32_t size);
+
+      uint32_t size() const { return m_size; }
+      kiss_fft_cpx *data() { return m_data; }
+      const kiss_fft_cpx *data() const { return m_data; }
+      kiss_fft_cpx &operator[](uint32_t i) { return m_data[i]; }
+      const kiss_fft_cpx &operator[](uint32_t i) const { return m_data[i]; }
+
+     private:
+      fft_buffer(const fft_buffer &);
+      fft_buffer &operator=(const fft_buffer &);
+
+      kiss_fft_cpx *m_data; ///< volk_malloc'ed storage
+      uint32_t m_size;      ///< number of elements
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_FFT_PLAN_CACHE_H */
@@ -0,0 +1,131 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <volk/volk.h>
+#include "frame_modulator.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    frame_modulator::frame_modulator(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words)
+    {
+        m_sf = sf;
+        m_samp_rate = samp_rate;
+        m_bw = bw;
+
+        //a single network identifier gives the two sync words
+        if (sync_words.size() == 1)
+        {
+            m_sync_words[0] = ((sync_words[0] & 0xF0) >> 4) << 3;
+            m_sync_words[1] = (sync_words[0] & 0x0F) << 3;
+        }
+        else
+        {
+            m_sync_words[0] = sync_words.size() > 0 ? sync_words[0] : 0;
+            m_sync_words[1] = sync_words.size() > 1 ? sync_words[1] : 0;
+        }
+
+        m_n_up = 8;
+        m_inter_frame_padding = 0;
+        m_format = SAMPLE_FC32;
+        m_out_scale = 1;
+        m_read = 0;
+    }
+
+    void frame_modulator::set_output_format(sample_format format, float full_scale)
+    {
+        m_format = format;
+        m_out_scale = full_scale > 0 ? full_scale : default_full_scale(format);
+    }
+
+    int frame_modulator::frame_samples(int payload_len) const
+    {
+        chirp_nco nco(m_sf, m_samp_rate, m_bw);
+        return nco.samples(4 * (payload_len + m_n_up + 4 + m_inter_frame_padding) + 1);
+    }
+
+    int frame_modulator::write_frame(const uint8_t *payload, int payload_len, gr_complex *out) const
+    {
+        // every frame starts at phase 0, so that it can be cached
+        chirp_nco nco(m_sf, m_samp_rate, m_bw);
+        gr_complex *start = out;
+        for (uint32_t i = 0; i < m_n_up; i++)
+            out += nco.upchirp(out, 0);
+        out += nco.upchirp(out, m_sync_words[0]);
+        out += nco.upchirp(out, m_sync_words[1]);
+        out += nco.downchirp(out);
+        out += nco.downchirp(out);
+        out += nco.downchirp(out, 1);
+        for (int i = 0; i < payload_len; i++)
+            out += nco.upchirp(out, payload[i]);
+        for (int i = 0; i < m_inter_frame_padding; i++)
+            out += nco.zeros(out);
+        return out - start;
+    }
+
+    waveform_cache::waveform frame_modulator::frame(const uint8_t *payload, int payload_len) const
+    {
+        waveform_key key(m_sf, m_samp_rate, m_bw, m_sync_words[0], m_sync_words[1], m_inter_frame_padding,
+                         std::vector<uint8_t>(payload, payload + payload_len));
+        return waveform_cache::instance().get(key, [&](std::vector<gr_complex> &wave) {
+            wave.resize(frame_samples(payload_len));
+            write_frame(payload, payload_len, &wave[0]);
+        });
+    }
+
+    int frame_modulator::output(void *out, int noutput, std::vector<frame_position> &frames)
+    {
+        uint8_t *o = static_cast<uint8_t *>(out);
+        size_t size = sample_size(m_format);
+        int produced = 0;
+        while (produced < noutput && !m_queue.empty())
+        {
+            const std::vector<gr_complex> &wave = *m_queue.front();
+            if (m_read == 0)
+            {
+                frame_position frame;
+                frame.offset = produced;
+                frame.nsamples = wave.size();
+                frames.push_back(frame);
+            }
+            //a frame may not fit in the output, the rest of it goes first in the next call
+            int n = std::min<int>(wave.size() - m_read, noutput - produced);
+            const float *samples = reinterpret_cast<const float *>(&wave[m_read]);
+            if (m_format == SAMPLE_SC16)
+                volk_32f_s32f_convert_16i(reinterpret_cast<int16_t *>(o + produced * size), samples, m_out_scale, 2 * n);
+            else if (m_format == SAMPLE_SC8)
+                volk_32f_s32f_convert_8i(reinterpret_cast<int8_t *>(o + produced * size), samples, m_out_scale, 2 * n);
+            else
+                memcpy(o + produced * size, samples, n * sizeof(gr_complex));
+            produced += n;
+            m_read += n;
+            if (m_read == wave.size())
+            {
+                m_queue.pop_front();
+                m_read = 0;
+            }
+        }
+        return produced;
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
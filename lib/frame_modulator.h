@@ -0,0 +1,148 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_FRAME_MODULATOR_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_FRAME_MODULATOR_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <CounterClockwiseAlarms/dsp_complex.h>
+#include <CounterClockwiseAlarms/sample_format.h>
+#include "chirp_nco.h"
+#include "waveform_cache.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Position of a frame in the output of frame_modulator::output()
+     */
+    struct frame_position
+    {
+        int offset;     ///< index of the first sample of the frame in the output
+        int nsamples;   ///< number of samples of the frame, padding included
+    };
+
+    /**
+     *  \brief  Modulation of whole frames, queued and copied into a block output.
+     *
+     *  A frame is the preamble (n_up upchirps, the 2 sync words and 2.25 downchirps), one
+     *  upchirp per payload symbol and the inter-frame padding, as DownModulate sends it.
+     *  Frames come from waveform_cache: a frame sent before is not modulated again, and
+     *  sending it is a copy into the output buffer, over several calls if it doesn't fit.
+     *  The cached frames are complex float, integer outputs are converted during that copy.
+     */
+    class frame_modulator
+    {
+     public:
+      /**
+       *  \param  sf
+       *          The spreading factor
+       *  \param  samp_rate
+       *          The sampling rate, at least bw
+       *  \param  bw
+       *          The bandwidth
+       *  \param  sync_words
+       *          The network identifier, one value or the two sync word symbols
+       */
+      frame_modulator(uint8_t sf, uint32_t samp_rate, uint32_t bw, std::vector<uint16_t> sync_words);
+
+      /**
+       *  \brief  Set the number of zero symbols appended to each frame
+       */
+      void set_inter_frame_padding(int symbols) { m_inter_frame_padding = symbols; }
+
+      /**
+       *  \brief  Set the format of the samples written by output(), SAMPLE_FC32 by default
+       *
+       *  \param  full_scale
+       *          The integer value of an amplitude of 1.0, 0 for default_full_scale(format).
+       *          Samples beyond the integer range saturate.
+       */
+      void set_output_format(sample_format format, float full_scale = 0);
+
+      /**
+       *  \brief  Number of samples of a frame, padding included
+       *
+       *  \param  payload_len
+       *          The number of payload symbols
+       */
+      int frame_samples(int payload_len) const;
+
+      /**
+       *  \brief  Modulate a whole frame.
+       *
+       *  \param  payload
+       *          The payload symbols
+       *  \param  payload_len
+       *          The number of payload symbols
+       *  \param  out
+       *          The output, frame_samples(payload_len) samples long
+       *  \return The number of samples written
+       */
+      int write_frame(const uint8_t *payload, int payload_len, gr_complex *out) const;
+
+      /**
+       *  \brief  Return the frame of a payload, from waveform_cache
+       */
+      waveform_cache::waveform frame(const uint8_t *payload, int payload_len) const;
+
+      /**
+       *  \brief  Queue a frame for output()
+       */
+      void push(const uint8_t *payload, int payload_len) { m_queue.push_back(frame(payload, payload_len)); }
+
+      /**
+       *  \brief  Whether some frame is waiting to be output
+       */
+      bool pending() const { return !m_queue.empty(); }
+
+      /**
+       *  \brief  Output the queued frames.
+       *
+       *  \param  out
+       *          The output buffer, in the output format
+       *  \param  noutput
+       *          The number of samples available in out
+       *  \param  frames
+       *          Gets the position of each frame started during the call
+       *  \return The number of samples written
+       */
+      int output(void *out, int noutput, std::vector<frame_position> &frames);
+
+     private:
+      uint8_t m_sf;                           ///< Spreading factor
+      uint32_t m_samp_rate;                   ///< Sampling rate
+      uint32_t m_bw;                          ///< Bandwidth
+      uint16_t m_sync_words[2];               ///< Sync word symbols
+      uint32_t m_n_up;                        ///< Number of upchirps in the preamble
+      int m_inter_frame_padding;              ///< Number of zero symbols after each frame
+      sample_format m_format;                 ///< Format of the output samples
+      float m_out_scale;                      ///< Integer value of an amplitude of 1.0
+
+      std::deque<waveform_cache::waveform> m_queue; ///< Frames not output yet
+      size_t m_read;                          ///< Number of samples of the first frame of m_queue already output
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_FRAME_MODULATOR_H */
@@ -0,0 +1,603 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <volk/volk.h>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "frame_sync_engine.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    using lora_sdr::mod;
+
+    frame_sync_engine::frame_sync_engine(float samp_rate, uint32_t bandwidth, uint8_t sf, std::vector<uint16_t> sync_word)
+      : m_decimator((uint32_t)std::lround(samp_rate), bandwidth)
+    {
+      m_bw                = bandwidth;
+      m_samp_rate         = samp_rate;
+      m_sf                = sf;
+      m_sync_words        = sync_word;
+      symbols_to_skip     = 4;
+      n_up                = 8;
+
+      up_symb_to_use      = 6;
+
+      lambda_sto = 0;
+
+      m_squelch_thresh = 0;
+      m_noise_floor = 0;
+
+      //Convert given sync word into the two modulated values in preamble
+      if(m_sync_words.size()==1){
+          uint16_t tmp = m_sync_words[0];
+          m_sync_words.resize(2,0);
+          m_sync_words[0] = ((tmp&0xF0)>>4)<<3;
+          m_sync_words[1] = (tmp&0x0F)<<3;
+      }
+
+      m_number_of_bins     = (uint32_t)(1u << m_sf);
+      //the DSP works at one sample per chip, the decimator brings the input down to the bandwidth
+      m_samples_per_symbol = m_number_of_bins;
+
+      m_window_len = m_decimator.input_needed(m_number_of_bins);
+
+      m_upchirp.resize(m_samples_per_symbol);
+      m_downchirp.resize(m_samples_per_symbol);
+      preamble_up.resize(n_up*m_samples_per_symbol);
+      symb_corr.resize(m_samples_per_symbol);
+      in_down.resize(m_number_of_bins);
+      m_block_windows = 8;
+      m_det_chips.resize(m_block_windows*m_number_of_bins);
+      m_det_chips_read = 0;
+      m_det_chips_len = 0;
+      preamble_raw.resize(n_up*m_samples_per_symbol);
+      m_history.resize(n_up*m_samples_per_symbol);
+      m_fft_mag.resize(m_number_of_bins);
+
+      lora_sdr::build_ref_chirps(&m_upchirp[0], &m_downchirp[0], m_sf);
+
+      m_history_cnt = 0;
+      k_hat = 0;
+      m_base = 0;
+      m_det_pos = 0;
+      m_det_frac = 0;
+      m_completed = 0;
+      m_emitting = -1;
+      m_emitted = 0;
+      m_telemetry = 0;
+      m_frame_cnt = 0;
+
+      //FFT plans are shared with the other blocks
+      m_fft_cfg = fft_plan_cache::instance().get(m_samples_per_symbol);
+      cx_out.resize(m_samples_per_symbol);
+      m_demod = symbol_demodulator::make(m_sf);
+
+      //the CFO and STO refinement works on the preamble summed by blocks, about 64 per symbol
+      m_zoom_decim = std::max(m_number_of_bins/64, 1u);
+      m_preamble_dechirped.resize(up_symb_to_use*m_number_of_bins);
+      m_coarse_mag.resize(m_number_of_bins);
+      m_zoom_mix.resize(m_zoom_decim);
+      m_zoom_dec.resize(up_symb_to_use*m_number_of_bins/m_zoom_decim);
+      m_zoom_mag.resize(3*up_symb_to_use*2+1);
+      //控制信息帧固定不变: one payload symbol followed by the 2 bytes of its CRC
+      m_symb_numb = 1+2;
+      set_max_frames(4);
+    }
+
+    void frame_sync_engine::set_symb_numb(uint32_t symb_numb)
+    {
+        m_symb_numb = symb_numb;
+        for (size_t i = 0; i < m_trackers.size(); i++)
+            m_trackers[i].payload.resize(m_symb_numb*m_number_of_bins);
+    }
+
+    void frame_sync_engine::set_max_frames(int max_frames)
+    {
+        size_t old_size = m_trackers.size();
+        m_trackers.resize(std::max(max_frames, 1));
+        if (m_emitting >= (int)m_trackers.size())
+            m_emitting = -1;
+        for (size_t i = 0; i < m_trackers.size(); i++) {
+            if (i >= old_size) {
+                m_trackers[i].active = false;
+                m_trackers[i].complete = false;
+            }
+            m_trackers[i].cfo_frac_correc.resize(m_number_of_bins);
+            m_trackers[i].payload.resize(m_symb_numb*m_number_of_bins);
+        }
+    }
+
+    void frame_sync_engine::set_squelch_threshold(float threshold_db)
+    {
+        m_squelch_thresh = threshold_db > 0 ? std::pow(10.0f, threshold_db/10) : 0;
+    }
+
+    void frame_sync_engine::reset()
+    {
+        m_candidates.clear();
+        //completed frames are kept, one of them may be half way out
+        for (size_t i = 0; i < m_trackers.size(); i++)
+            if (!m_trackers[i].complete)
+                m_trackers[i].active = false;
+    }
+
+    void frame_sync_engine::zoom_spectrum(const gr_complex *samples, int len, int bin, int interp, int half_span, float *mag)
+    {
+        int nblocks = len/m_zoom_decim;
+        //bring the samples down to baseband around bin and sum them by blocks, the tone lies
+        //within a few bins of baseband where the droop of the block sum is negligible
+        for (uint32_t d = 0; d < m_zoom_decim; d++)
+            m_zoom_mix[d] = expj(-2*M_PI*mod((long)bin*d,m_number_of_bins)/m_number_of_bins);
+        for (int m = 0; m < nblocks; m++) {
+            gr_complex block;
+            volk_32fc_x2_dot_prod_32fc(&block, &samples[m*m_zoom_decim], &m_zoom_mix[0], m_zoom_decim);
+            m_zoom_dec[m] = block*expj(-2*M_PI*mod((int64_t)bin*m*m_zoom_decim,m_number_of_bins)/m_number_of_bins);
+        }
+        //evaluate the spectrum of the decimated samples on the fine grid only
+        for (int j = -half_span; j <= half_span; j++) {
+            gr_complex step = expj(-2*M_PI*j*m_zoom_decim/(interp*(double)m_number_of_bins));
+            gr_complex phase(1,0);
+            gr_complex acc(0,0);
+            for (int m = 0; m < nblocks; m++) {
+                acc += m_zoom_dec[m]*phase;
+                phase *= step;
+            }
+            mag[j+half_span] += std::norm(acc);
+        }
+    }
+
+    void frame_sync_engine::estimate_CFO(const gr_complex* samples){
+        int k0, k_c;
+        double Y_1, Y0, Y1, u, v, ka, wa, k_residual;
+        //the zero padded FFT of the up_symb_to_use symbols has interp points per bin, only
+        //±1.5 bins around the coarse peak are evaluated
+        int interp = 2*up_symb_to_use;
+        int half_span = 3*interp/2;
+        uint32_t peak;
+
+        //Dechirping, then coarse search on the sum of the symbol spectra
+        std::fill(m_coarse_mag.begin(), m_coarse_mag.end(), 0);
+        for (int i = 0; i < up_symb_to_use; i++) {
+            volk_32fc_x2_multiply_32fc(&m_preamble_dechirped[i*m_number_of_bins],&samples[i*m_number_of_bins],&m_downchirp[0],m_number_of_bins);
+            kiss_fft(m_fft_cfg,reinterpret_cast<const kiss_fft_cpx *>(&m_preamble_dechirped[i*m_number_of_bins]),cx_out.data());
+            volk_32fc_magnitude_squared_32f(&m_fft_mag[0],reinterpret_cast<const gr_complex *>(cx_out.data()),m_number_of_bins);
+            volk_32f_x2_add_32f(&m_coarse_mag[0],&m_coarse_mag[0],&m_fft_mag[0],m_number_of_bins);
+        }
+        volk_32f_index_max_32u(&peak,&m_coarse_mag[0],m_number_of_bins);
+        k_c = peak;
+
+        // zoom on the peak
+        std::fill(m_zoom_mag.begin(), m_zoom_mag.end(), 0);
+        zoom_spectrum(&m_preamble_dechirped[0],up_symb_to_use*m_number_of_bins,k_c,interp,half_span,&m_zoom_mag[0]);
+        int j = std::max_element(m_zoom_mag.begin()+1, m_zoom_mag.begin()+2*half_span) - m_zoom_mag.begin();
+        k0 = mod(k_c*interp+j-half_span,interp*m_number_of_bins);
+
+        // get three spectral lines
+        Y_1 = m_zoom_mag[j-1];
+        Y0 = m_zoom_mag[j];
+        Y1 = m_zoom_mag[j+1];
+        //set constant coeff
+        u = 64*m_number_of_bins/406.5506497; //from Cui yang (15)
+        v = u*2.4674;
+        //RCTSL
+        wa = (Y1-Y_1)/(u*(Y1+Y_1)+v*Y0);
+        ka = wa*m_number_of_bins/M_PI;
+        k_residual = fmod((k0+ka)/2/up_symb_to_use,1);
+        lambda_cfo = k_residual - (k_residual>0.5?1:0);
+        //bin of the preamble once the fractional CFO is removed, where the STO search starts
+        m_preamble_bin = mod(lround((k0+ka)/interp-lambda_cfo),m_number_of_bins);
+        // Correct CFO in preamble
+        gr_complex phase(1,0);
+        volk_32fc_s32fc_x2_rotator_32fc(&preamble_up[0],samples,expj(-2* M_PI *lambda_cfo/m_number_of_bins),&phase,up_symb_to_use*m_number_of_bins);
+    }
+    void frame_sync_engine::estimate_STO(){
+        int k0;
+        double Y_1, Y0, Y1, u, v, ka, wa, k_residual;
+        //the zero padded FFT of each symbol has 2 points per bin, only ±1.5 bins around the
+        //preamble bin are evaluated
+        int half_span = 3;
+
+        std::fill(m_zoom_mag.begin(), m_zoom_mag.begin()+2*half_span+1, 0);
+        for (int i = 0; i < up_symb_to_use; i++) {
+            //Dechirping
+            volk_32fc_x2_multiply_32fc(&m_preamble_dechirped[0],&preamble_up[m_number_of_bins*i],&m_downchirp[0],m_samples_per_symbol);
+            //the spectra of all the symbols are summed
+            zoom_spectrum(&m_preamble_dechirped[0],m_number_of_bins,m_preamble_bin,2,half_span,&m_zoom_mag[0]);
+        }
+
+        // get argmax here
+        int j = std::max_element(m_zoom_mag.begin()+1, m_zoom_mag.begin()+2*half_span) - m_zoom_mag.begin();
+        k0 = mod(2*m_preamble_bin+j-half_span,2*m_number_of_bins);
+
+        // get three spectral lines
+        Y_1 = m_zoom_mag[j-1];
+        Y0 = m_zoom_mag[j];
+        Y1 = m_zoom_mag[j+1];
+        //set constant coeff
+        u = 64*m_number_of_bins/406.5506497; //from Cui yang (eq.15)
+        v = u*2.4674;
+        //RCTSL
+        wa = (Y1-Y_1)/(u*(Y1+Y_1)+v*Y0);
+        ka = wa*m_number_of_bins/M_PI;
+        k_residual = fmod((k0+ka)/2,1);
+        lambda_sto = k_residual - (k_residual>0.5?1:0);
+
+    }
+
+    uint32_t frame_sync_engine::get_symbol_val(const gr_complex *samples, gr_complex *ref_chirp) {
+        demod_result res;
+        m_demod->demod(samples, ref_chirp, res);
+        // Return argmax here
+        return res.total_energy?res.bin:-1;
+    }
+
+    void frame_sync_engine::find_peaks()
+    {
+        //one peak per frame possibly on the air, the strongest first
+        m_peaks.clear();
+        volk_32fc_magnitude_squared_32f(&m_fft_mag[0], m_demod->spectrum(), m_number_of_bins);
+        float strongest = 0;
+        for (size_t i = 0; i < m_trackers.size()+1; i++) {
+            uint32_t peak;
+            volk_32f_index_max_32u(&peak, &m_fft_mag[0], m_number_of_bins);
+            //the sidelobes of a symbol not aligned on the bins are more than 10dB under its peak,
+            //weaker frames can't be told apart from them
+            if(m_fft_mag[peak] <= 0.1f*strongest || m_fft_mag[peak] <= 0)
+                break;
+            if(!i)
+                strongest = m_fft_mag[peak];
+            m_peaks.push_back(peak);
+            //a symbol not aligned on the bins spreads over the neighbouring ones
+            for (int k = -2; k <= 2; k++)
+                m_fft_mag[mod((long)peak+k,m_number_of_bins)] = 0;
+        }
+    }
+
+    int32_t frame_sync_engine::match_peak(int32_t bin_idx, int32_t value)
+    {
+        if(std::abs(bin_idx-value)<=1)
+            return bin_idx;
+        //under a stronger frame the expected value is only one of the next peaks
+        find_peaks();
+        for (size_t i = 1; i < m_peaks.size(); i++)
+            if(std::abs(m_peaks[i]-value)<=1)
+                return m_peaks[i];
+        return bin_idx;
+    }
+
+    float frame_sync_engine::determine_energy(const gr_complex *samples) {
+            gr_complex energy_chirp;
+            volk_32fc_x2_conjugate_dot_prod_32fc(&energy_chirp, samples, samples, m_samples_per_symbol);
+            return energy_chirp.real();
+        }
+    void
+    frame_sync_engine::decimate_block(const void *in, int ninput)
+    {
+      //as many whole windows as the input holds, the detector has no STO to correct
+      int64_t pos = 0;
+      uint32_t frac = m_det_frac;
+      int nwindows = 0;
+      while(nwindows < m_block_windows && pos+m_window_len <= ninput){
+          pos += m_decimator.advance(m_samples_per_symbol, frac);
+          nwindows++;
+      }
+      m_decimator.decimate(in, &m_det_chips[0], nwindows*m_number_of_bins, 0, m_det_frac);
+      m_det_chips_read = 0;
+      m_det_chips_len = nwindows*m_number_of_bins;
+    }
+
+    void
+    frame_sync_engine::detect_symbol(const gr_complex *chips)
+    {
+      memcpy(&m_history[(m_history_cnt%n_up)*m_samples_per_symbol],chips,m_samples_per_symbol*sizeof(gr_complex));
+      m_history_cnt++;
+
+      bool squelched = false;
+      if(m_squelch_thresh){
+          //measured on the decimated chips, the noise out of the band doesn't dilute the signal
+          float energy = determine_energy(chips);
+          squelched = energy < m_squelch_thresh*m_noise_floor;
+          //track the noise floor, following drops quickly and rises slowly so that preambles barely move it
+          if(m_noise_floor == 0)
+              m_noise_floor = energy;
+          else
+              m_noise_floor += (energy < m_noise_floor ? 0.1f : 0.001f)*(energy-m_noise_floor);
+      }
+
+      //an empty window breaks the preambles like a wrong symbol would
+      m_peaks.clear();
+      if(!squelched && get_symbol_val(chips, &m_downchirp[0]) != (uint32_t)-1){
+          find_peaks();
+      }
+
+      //look for consecutive reference upchirps(with a margin of ±1)
+      size_t kept = 0;
+      for (size_t i = 0; i < m_candidates.size(); i++) {
+          preamble_candidate c = m_candidates[i];
+          std::vector<int32_t>::iterator p = m_peaks.begin();
+          while(p != m_peaks.end() && std::abs(*p-c.bin)>1)
+              ++p;
+          if(p == m_peaks.end())
+              continue;
+          c.bin = *p;
+          c.k_sum += *p;
+          c.count++;
+          m_peaks.erase(p);
+          if(c.count == (int)(n_up-1))
+              start_tracker(c);
+          else
+              m_candidates[kept++] = c;
+      }
+      m_candidates.resize(kept);
+      //the other peaks may be the first upchirp of a preamble
+      for (size_t i = 0; i < m_peaks.size(); i++) {
+          preamble_candidate c;
+          c.bin = m_peaks[i];
+          c.k_sum = m_peaks[i];
+          c.count = 1;
+          m_candidates.push_back(c);
+      }
+      m_det_chips_read += m_number_of_bins;
+      m_det_pos += m_decimator.advance(m_samples_per_symbol, m_det_frac);
+    }
+
+    void
+    frame_sync_engine::start_tracker(const preamble_candidate &candidate)
+    {
+      k_hat = round(candidate.k_sum/(n_up-1));
+
+      //a tracker still reading upchirps with about the same k_hat follows this very preamble, the
+      //peak of a preamble not aligned on the windows may also have given two candidates
+      frame_tracker *tracker = 0;
+      for (size_t i = 0; i < m_trackers.size(); i++) {
+          frame_tracker &t = m_trackers[i];
+          if(!t.active){
+              if(!tracker)
+                  tracker = &t;
+          }
+          else if(t.state == SYNC && t.symbol_cnt == NET_ID1){
+              int diff = mod(t.k_hat-k_hat, m_number_of_bins);
+              if(diff<=2 || diff>=(int)m_number_of_bins-2)
+                  return;
+          }
+      }
+      //without a free tracker the frame is lost
+      if(!tracker)
+          return;
+
+      //put the windows of the preamble back in order
+      for (uint32_t i = 0; i < n_up-1; i++) {
+          uint32_t slot = (m_history_cnt-(n_up-1)+i)%n_up;
+          memcpy(&preamble_raw[i*m_samples_per_symbol],&m_history[slot*m_samples_per_symbol],m_samples_per_symbol*sizeof(gr_complex));
+      }
+      estimate_CFO(&preamble_raw[m_number_of_bins-k_hat]);
+      estimate_STO();
+
+      tracker->active = true;
+      tracker->complete = false;
+      tracker->state = SYNC;
+      tracker->symbol_cnt = NET_ID1;
+      tracker->k_hat = k_hat;
+      tracker->lambda_cfo = lambda_cfo;
+      tracker->lambda_sto = lambda_sto;
+      //create correction vector
+      for (uint32_t n = 0; n< m_number_of_bins; n++) {
+          tracker->cfo_frac_correc[n]= expj(-2* M_PI *lambda_cfo/m_number_of_bins*n) ;
+      }
+      //perform the coarse synchronization, from the window being processed
+      tracker->frac = m_det_frac;
+      tracker->pos = m_det_pos + m_decimator.advance(m_samples_per_symbol-k_hat, tracker->frac);
+    }
+
+    void
+    frame_sync_engine::track_symbol(frame_tracker &t, const void *in)
+    {
+      int items_to_consume = m_samples_per_symbol;
+      bool synced = false;
+
+      //downsampling, the fractional STO selects the filter phase
+      m_decimator.decimate(in, &in_down[0], m_number_of_bins, t.lambda_sto, t.frac);
+      switch (t.state) {
+        case SYNC:{
+            //apply cfo correction
+            volk_32fc_x2_multiply_32fc(&symb_corr[0],&in_down[0],&t.cfo_frac_correc[0],m_samples_per_symbol);
+
+            int32_t bin_idx = get_symbol_val(&symb_corr[0], &m_downchirp[0]);
+            switch (t.symbol_cnt) {
+                case NET_ID1:{
+                    if(bin_idx==0||bin_idx==1||bin_idx==(int32_t)m_number_of_bins-1){// look for additional upchirps. Won't work if network identifier 1 equals 2^sf-1, 0 or 1!
+                    }
+                    else if (abs((bin_idx = match_peak(bin_idx, m_sync_words[0]))-(int32_t)m_sync_words[0])>1){ //wrong network identifier
+                        t.active = false;
+                    }
+                    else { //network identifier 1 correct or off by one
+                        t.net_id_off=bin_idx-(int32_t)m_sync_words[0];
+                        t.symbol_cnt = NET_ID2;
+                    }
+                    break;
+                }
+                case NET_ID2:{
+                    bin_idx = match_peak(bin_idx, m_sync_words[1]);
+                    if (abs(bin_idx-(int32_t)m_sync_words[1])>1){ //wrong network identifier
+                        t.active = false;
+                    }
+                    else if(t.net_id_off && (bin_idx-(int32_t)m_sync_words[1])==t.net_id_off){//correct case off by one net id
+                        items_to_consume-=t.net_id_off;
+                        t.symbol_cnt = DOWNCHIRP1;
+                    }
+                    else{
+                        t.symbol_cnt = DOWNCHIRP1;
+                    }
+                    break;
+                }
+                case DOWNCHIRP1:
+                    t.symbol_cnt = DOWNCHIRP2;
+                    break;
+                case DOWNCHIRP2:{
+                    t.down_val = get_symbol_val(&symb_corr[0], &m_upchirp[0]);
+                    t.symbol_cnt = QUARTER_DOWN;
+                    break;
+                }
+                case QUARTER_DOWN:{
+                    if (t.down_val <  (int)m_number_of_bins/2){
+                        t.cfo_int = floor(t.down_val/2);
+                    }
+                    else{
+                        t.cfo_int = floor(double(t.down_val-(int)m_number_of_bins)/2);
+                    }
+
+                    items_to_consume = m_samples_per_symbol/4+t.cfo_int;
+
+                    t.symbol_cnt = 0;
+                    t.state = FRAC_CFO_CORREC;
+                    synced = true;
+                }
+            }
+            break;
+        }
+        case FRAC_CFO_CORREC:{
+            //keep only useful symbols (at least 8 symbol for PHY header)
+            //apply fractional cfo correction
+            volk_32fc_x2_multiply_32fc(&t.payload[t.symbol_cnt*m_number_of_bins],&in_down[0],&t.cfo_frac_correc[0],m_samples_per_symbol);
+            t.symbol_cnt++;
+            //the frame is output as a whole, once it is complete
+            if(t.symbol_cnt >= (int32_t)m_symb_numb){
+                t.complete = true;
+                t.seq = m_completed++;
+            }
+            break;
+        }
+        default: {
+            std::cerr << "[LoRa sync] WARNING : No state! Shouldn't happen\n";
+            break;
+        }
+      }
+      t.pos += m_decimator.advance(items_to_consume, t.frac);
+
+      //the frame offsets are known once the quarter downchirp is skipped
+      if(synced){
+          t.payload_pos = t.pos;
+          if(m_telemetry){
+              sync_telemetry record;
+              record.sample_index = t.pos;
+              record.lambda_cfo = t.lambda_cfo;
+              record.lambda_sto = t.lambda_sto;
+              record.k_hat = t.k_hat;
+              record.cfo_int = t.cfo_int;
+              record.frame_cnt = m_frame_cnt;
+              record.net_id_off = t.net_id_off;
+              record.sf = m_sf;
+              record.reserved = 0;
+              m_telemetry->push(record);
+          }
+          m_frame_cnt++;
+      }
+    }
+
+    int
+    frame_sync_engine::output_frames(gr_complex *out, int produced, int noutput, std::vector<frame_start> &frames)
+    {
+      while(produced < noutput){
+          if(m_emitting < 0){
+              //the frame completed first goes out first
+              for (size_t i = 0; i < m_trackers.size(); i++)
+                  if(m_trackers[i].active && m_trackers[i].complete
+                     && (m_emitting < 0 || m_trackers[i].seq < m_trackers[m_emitting].seq))
+                      m_emitting = i;
+              if(m_emitting < 0)
+                  break;
+              m_emitted = 0;
+              frame_start frame;
+              frame.out_index = produced;
+              frame.cfo_int = m_trackers[m_emitting].cfo_int;
+              frame.sample_index = m_trackers[m_emitting].payload_pos;
+              frames.push_back(frame);
+          }
+          //a frame may not fit in the output, the rest of it goes first in the next call
+          frame_tracker &t = m_trackers[m_emitting];
+          int n = std::min<int>(t.symbol_cnt-m_emitted, noutput-produced);
+          memcpy(&out[produced*m_number_of_bins], &t.payload[m_emitted*m_number_of_bins], n*m_number_of_bins*sizeof(gr_complex));
+          produced += n;
+          m_emitted += n;
+          if((int32_t)m_emitted == t.symbol_cnt){
+              t.active = false;
+              t.complete = false;
+              m_emitting = -1;
+          }
+      }
+      return produced;
+    }
+
+    int
+    frame_sync_engine::work(const void *in, int ninput, gr_complex *out, int noutput, int &consumed,
+                            std::vector<frame_start> &frames)
+    {
+      const uint8_t *samples = static_cast<const uint8_t *>(in);
+      size_t sample_size = m_decimator.input_size();
+      int produced = output_frames(out, 0, noutput, frames);
+
+      //walk the symbol windows in input order, whether they belong to the detector or to a tracker
+      while(true){
+          frame_tracker *next = 0;
+          int64_t pos = m_det_pos;
+          for (size_t i = 0; i < m_trackers.size(); i++) {
+              if(m_trackers[i].active && !m_trackers[i].complete && m_trackers[i].pos < pos){
+                  next = &m_trackers[i];
+                  pos = next->pos;
+              }
+          }
+          if(pos-m_base+m_window_len > ninput)
+              break;
+
+          if(next){
+              track_symbol(*next, samples+(pos-m_base)*sample_size);
+              if(next->complete){
+                  produced = output_frames(out, produced, noutput, frames);
+                  //stop when the output is full rather than piling up frames in the trackers
+                  if(produced == noutput)
+                      break;
+              }
+          }
+          else{
+              if(m_det_chips_read == m_det_chips_len)
+                  decimate_block(samples+(pos-m_base)*sample_size, ninput-(pos-m_base));
+              detect_symbol(&m_det_chips[m_det_chips_read]);
+          }
+      }
+
+      //keep the input from the oldest symbol window still needed
+      int64_t oldest = m_det_pos;
+      for (size_t i = 0; i < m_trackers.size(); i++)
+          if(m_trackers[i].active && !m_trackers[i].complete)
+              oldest = std::min(oldest, m_trackers[i].pos);
+      consumed = oldest-m_base;
+      m_base = oldest;
+      return produced;
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,368 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_FRAME_SYNC_ENGINE_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_FRAME_SYNC_ENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include <CounterClockwiseAlarms/dsp_complex.h>
+#include "fft_plan_cache.h"
+#include "symbol_demod.h"
+#include "polyphase_decimator.h"
+#include "spsc_ring.h"
+#include <CounterClockwiseAlarms/sync_telemetry.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Start of a synchronized frame found by frame_sync_engine::work
+     */
+    struct frame_start
+    {
+        int out_index;  ///< index, in the output of the work call, of the first symbol of the frame
+        int cfo_int;    ///< integer part of the CFO of the frame
+        int64_t sample_index; ///< input sample index of the first payload symbol of the frame, counted from the first work call
+    };
+
+    /**
+     *  \brief  Preamble detection and frame synchronization state machine of one spreading factor.
+     *
+     *  This is the DSP of the FrameSync block without any dependency on the GNU Radio runtime,
+     *  so that several of them can run on the same input buffer. The engine doesn't own its
+     *  input: work() is given the samples starting at the oldest symbol window still needed and
+     *  reports how many of them are no longer needed.
+     *
+     *  The preamble detector never stops. Each preamble it finds is handed to a frame tracker
+     *  holding the k_hat, CFO and STO of that frame, so frames overlapping in time are
+     *  synchronized and demodulated side by side. A tracker keeps the payload symbols of its
+     *  frame until all of them are received, then the whole frame is output at once: the
+     *  output is always made of contiguous frames, in the order they ended.
+     */
+    class frame_sync_engine
+    {
+     public:
+      frame_sync_engine(float samp_rate, uint32_t bandwidth, uint8_t sf, std::vector<uint16_t> sync_word);
+
+      uint8_t sf() const { return m_sf; }
+      uint32_t number_of_bins() const { return m_number_of_bins; }
+
+      /**
+       *  \brief  Number of input samples needed to process one symbol window
+       */
+      int window_len() const { return m_window_len; }
+
+      /**
+       *  \brief  Set the number of payload symbols forwarded after each synchronized frame,
+       *          3 by default: the alarm ID and its CRC
+       */
+      void set_symb_numb(uint32_t symb_numb);
+
+      /**
+       *  \brief  Set the number of frames that can be synchronized at the same time. Preambles
+       *          found while every tracker is busy are dropped.
+       */
+      void set_max_frames(int max_frames);
+
+      /**
+       *  \brief  Skip the FFT of symbol windows less than threshold_db above the noise floor, 0 disables
+       */
+      void set_squelch_threshold(float threshold_db);
+
+      /**
+       *  \brief  Set the format of the input samples, SAMPLE_FC32 by default. Integer samples are
+       *          converted by the decimator, as they are filtered.
+       *
+       *  \param  full_scale
+       *          The integer value of an amplitude of 1.0, 0 for default_full_scale(format)
+       */
+      void set_input_format(sample_format format, float full_scale = 0) { m_decimator.set_input_format(format, full_scale); }
+
+      /**
+       *  \brief  Push a sync_telemetry record to ring for each frame synchronized, 0 disables.
+       *          The engine is the producer of the ring.
+       */
+      void set_telemetry(spsc_ring<sync_telemetry> *ring) { m_telemetry = ring; }
+
+      /**
+       *  \brief  Drop the frames being synchronized and restart the preamble detection
+       */
+      void reset();
+
+      /**
+       *  \brief  Run the state machine over every symbol window available.
+       *
+       *  \param  in
+       *          The input samples, starting at the oldest symbol window still needed, in the input format
+       *  \param  ninput
+       *          The number of input samples
+       *  \param  out
+       *          The output, vectors of number_of_bins() samples with the CFO frac corrected payload symbols
+       *  \param  noutput
+       *          The maximum number of output vectors
+       *  \param  consumed
+       *          Set to the number of input samples that can be dropped
+       *  \param  frames
+       *          The frames synchronized during the call are appended to it
+       *  \return The number of output vectors written
+       */
+      int work(const void *in, int ninput, gr_complex *out, int noutput, int &consumed,
+               std::vector<frame_start> &frames);
+
+     private:
+      friend struct frame_sync_engine_bench; ///< drives the CFO and STO estimators from bench/
+      friend struct frame_sync_engine_test;  ///< checks the CFO estimator in qa_cfo_estimation
+
+      enum DecoderState {
+            SYNC,
+            FRAC_CFO_CORREC
+      };
+      enum SyncState {
+          NET_ID1,
+          NET_ID2,
+          DOWNCHIRP1,
+          DOWNCHIRP2,
+          QUARTER_DOWN
+      };
+      uint32_t m_bw;          ///< Bandwidth
+      uint32_t m_samp_rate;   ///< Sampling rate
+      uint8_t m_sf;           ///< Spreading factor
+      std::vector<uint16_t> m_sync_words; ///< vector containing the two sync words (network identifiers)
+
+      uint32_t m_number_of_bins;      ///< Number of bins in each lora Symbol
+      uint32_t m_samples_per_symbol;  ///< Number of samples per lora symbol after decimation
+      uint32_t m_symb_numb;           ///< number of payload lora symbols
+
+      std::vector<gr_complex> in_down; ///< downsampled input
+      std::vector<gr_complex> m_downchirp; ///< Reference downchirp
+      std::vector<gr_complex> m_upchirp;   ///< Reference upchirp
+
+      /**
+       *  \brief  Run of consecutive symbol windows with a peak at the same bin, maybe a preamble
+       */
+      struct preamble_candidate
+      {
+          int32_t bin;            ///< value of the last peak of the run
+          int32_t count;          ///< Number of windows in the run
+          int32_t k_sum;          ///< sum of the peak values of the run
+      };
+      std::vector<preamble_candidate> m_candidates; ///< preambles being searched, one per peak of the last window
+      std::vector<int32_t> m_peaks;   ///< strongest peaks of the current window
+      std::vector<float> m_fft_mag;   ///< squared magnitude of the spectrum of the current window
+      std::vector<gr_complex> m_history; ///< the last n_up downsampled windows, circular
+      uint32_t m_history_cnt;     ///< Number of windows written to m_history
+
+      uint32_t n_up;              ///< Number of consecutive upchirps in preamble
+      uint8_t symbols_to_skip;    ///< Number of integer symbol to skip after consecutive upchirps
+
+      fft_buffer cx_out;          ///<output of the FFT
+      kiss_fft_cfg m_fft_cfg;     ///<plan of the symbol FFT, borrowed from fft_plan_cache
+      std::unique_ptr<symbol_demodulator> m_demod; ///<demodulation kernel of the spreading factor
+
+      std::vector<gr_complex> m_preamble_dechirped; ///< dechirped preamble used by the CFO and STO estimation
+      std::vector<float> m_coarse_mag;  ///< sum of the spectra of the preamble symbols
+      uint32_t m_zoom_decim;            ///< Number of samples summed together before the zoom
+      std::vector<gr_complex> m_zoom_mix; ///< phasors bringing a block to baseband
+      std::vector<gr_complex> m_zoom_dec; ///< preamble brought to baseband and decimated
+      std::vector<float> m_zoom_mag;    ///< squared magnitude of the spectrum on the fine grid
+      int m_preamble_bin;               ///< integer bin of the preamble with its fractional CFO corrected
+
+      polyphase_decimator m_decimator; ///< front end bringing the input down to one sample per chip, shared by the detector and the trackers
+      int m_window_len;           ///< Number of input samples needed by one symbol window
+      int m_block_windows;        ///< Number of detector windows decimated at once
+      std::vector<gr_complex> m_det_chips; ///< decimated chips of the next detector windows, from m_det_pos on
+      uint32_t m_det_chips_read;  ///< index in m_det_chips of the window at m_det_pos
+      uint32_t m_det_chips_len;   ///< number of chips in m_det_chips
+
+      std::vector<gr_complex> preamble_raw;///<vector containing the preamble upchirps without any synchronization
+      std::vector<gr_complex> preamble_up; ///<vector containing the preamble upchirps
+
+      int up_symb_to_use; ///<number of upchirp symbols to use for CFO and STO frac estimation
+      int k_hat;          ///<integer part of CFO+STO
+      float lambda_cfo;  ///<fractional part of CFO
+      float lambda_sto;  ///<fractional part of CFO
+
+      std::vector<gr_complex> symb_corr; ///< symbol with CFO frac corrected
+
+      /**
+       *  \brief  Synchronization state of one frame
+       */
+      struct frame_tracker
+      {
+          bool active;            ///< the tracker follows a frame
+          bool complete;          ///< every payload symbol has been received, the frame waits to be output
+          uint64_t seq;           ///< order in which the frames were completed
+          int64_t pos;            ///< input index of the next symbol window of the frame
+          int64_t payload_pos;    ///< input index of the first payload symbol
+          uint32_t frac;          ///< fractional part of pos, as kept by polyphase_decimator
+          uint8_t state;          ///< SYNC or FRAC_CFO_CORREC
+          int32_t symbol_cnt;     ///< Number of symbols already received in the current state
+          int k_hat;              ///< integer part of CFO+STO
+          float lambda_cfo;       ///< fractional part of CFO
+          float lambda_sto;       ///< fractional part of STO
+          int down_val;           ///< value of the preamble downchirps
+          int cfo_int;            ///< integer part of CFO
+          int net_id_off;         ///< offset of the network identifier
+          std::vector<gr_complex> cfo_frac_correc; ///< cfo frac correction vector
+          std::vector<gr_complex> payload;         ///< CFO frac corrected payload symbols
+      };
+      std::vector<frame_tracker> m_trackers; ///< pool of trackers, inactive ones are free
+      int64_t m_base;         ///< input index of the first sample given to work()
+      int64_t m_det_pos;      ///< input index of the next symbol window of the preamble detector
+      uint32_t m_det_frac;    ///< fractional part of m_det_pos
+      uint64_t m_completed;   ///< number of frames completed so far
+      int m_emitting;         ///< tracker whose frame is being output, -1 if none
+      uint32_t m_emitted;     ///< number of symbols of that frame already output
+
+      spsc_ring<sync_telemetry> *m_telemetry; ///< where to record the offsets of the frames, if anywhere
+      uint32_t m_frame_cnt;   ///< number of frames synchronized so far
+
+      float m_squelch_thresh; ///< energy ratio above the noise floor under which the detector skips the FFT, 0 when disabled
+      float m_noise_floor;    ///< running estimate of the energy of an empty symbol window
+
+      /**
+       *  \brief  Estimate the value of fractional part of the CFO using RCTSL on the zoomed spectrum
+       *          of the preamble, around the peak of the sum of its symbol spectra
+       *  \param  samples
+       *          The pointer to the preamble beginning.(We might want to avoid the
+       *          first symbol since it might be incomplete)
+       */
+      void estimate_CFO(const gr_complex* samples);
+      /**
+       *  \brief  Zoom FFT: add the squared magnitude of the spectrum of samples, on a grid interp times
+       *          finer than the symbol FFT, at the 2*half_span+1 points centered on bin to mag. The
+       *          samples are brought to baseband and summed by blocks of m_zoom_decim first, so the
+       *          cost is about two passes over the samples whatever the number of points.
+       *
+       *  \param  samples
+       *          The samples, len long
+       *  \param  len
+       *          The number of samples, a multiple of m_zoom_decim
+       *  \param  bin
+       *          The center of the grid, in bins of the symbol FFT
+       *  \param  interp
+       *          The number of grid points per bin
+       *  \param  half_span
+       *          The number of grid points on each side of the center
+       *  \param  mag
+       *          The 2*half_span+1 values to accumulate to
+       */
+      void zoom_spectrum(const gr_complex *samples, int len, int bin, int interp, int half_span, float *mag);
+      /**
+       *  \brief  Estimate the value of fractional part of the STO from the zoomed spectra of the CFO
+       *          corrected preamble symbols
+       **/
+      void estimate_STO();
+      /**
+       *  \brief  Recover the lora symbol value using argmax of the dechirped symbol FFT. Returns -1 in case of an fft window containing no energy to handle noiseless simulations.
+       *
+       *  \param  samples
+       *          The pointer to the symbol beginning.
+       *  \param  ref_chirp
+       *          The reference chirp to use to dechirp the lora symbol.
+       */
+      uint32_t get_symbol_val(const gr_complex *samples,gr_complex *ref_chirp);
+
+      /**
+       *  \brief  Fill m_peaks with the strongest peaks of the spectrum left by get_symbol_val,
+       *          one more than the number of trackers.
+       */
+      void find_peaks();
+
+      /**
+       *  \brief  Look for an expected symbol value among the peaks of the spectrum left by get_symbol_val.
+       *
+       *  \param  bin_idx
+       *          The argmax of the spectrum
+       *  \param  value
+       *          The expected value
+       *  \return The peak within ±1 of value if there is one, bin_idx otherwise
+       */
+      int32_t match_peak(int32_t bin_idx, int32_t value);
+
+      /**
+       *  \brief  Determine the energy of a symbol.
+       *
+       *  \param  samples
+       *          The complex symbol to analyse.
+       */
+      float determine_energy(const gr_complex *samples);
+
+      /**
+       *  \brief  Decimate the next detector windows at once into m_det_chips, as many as the
+       *          input holds up to m_block_windows. The trackers filter their own windows, their
+       *          fractional STO selects another phase of the filter.
+       *
+       *  \param  in
+       *          The pointer to the input at m_det_pos
+       *  \param  ninput
+       *          Number of input samples from m_det_pos on, at least window_len()
+       */
+      void decimate_block(const void *in, int ninput);
+
+      /**
+       *  \brief  Run the preamble detection on the symbol window at m_det_pos, and start a tracker
+       *          when a preamble is found. Every strong peak of the window extends or starts a
+       *          preamble candidate, so a preamble is found even under a stronger frame.
+       *
+       *  \param  chips
+       *          The decimated chips of the window, taken from m_det_chips
+       */
+      void detect_symbol(const gr_complex *chips);
+
+      /**
+       *  \brief  Hand the preamble ending with the current window to a free tracker
+       *
+       *  \param  candidate
+       *          The run of windows forming the preamble
+       */
+      void start_tracker(const preamble_candidate &candidate);
+
+      /**
+       *  \brief  Run the synchronization state machine of a tracker on its next symbol window.
+       *
+       *  \param  tracker
+       *          The frame tracker
+       *  \param  in
+       *          The pointer to the window beginning, window_len() samples long
+       */
+      void track_symbol(frame_tracker &tracker, const void *in);
+
+      /**
+       *  \brief  Output the completed frames, oldest first, as long as there is room.
+       *
+       *  \param  out
+       *          The output of the work call
+       *  \param  produced
+       *          The number of output vectors already written by the work call
+       *  \param  noutput
+       *          The maximum number of output vectors
+       *  \param  frames
+       *          The frames whose first symbol is output are appended to it
+       *  \return The number of output vectors written by the work call
+       */
+      int output_frames(gr_complex *out, int produced, int noutput, std::vector<frame_start> &frames);
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_FRAME_SYNC_ENGINE_H */
@@ -23,7 +23,10 @@
 #endif
 
 #include <gnuradio/io_signature.h>
+#include <gnuradio/block_detail.h>
 #include "mesCreater_impl.h"
+#include <stdexcept>
+#include <algorithm>
 
 namespace gr {
   namespace CounterClockwiseAlarms {
@@ -42,17 +45,24 @@ namespace gr {
     mesCreater_impl::mesCreater_impl(uint8_t mesDownId,uint8_t sf,uint8_t framelen)
       : gr::block("mesCreater",
               gr::io_signature::make(0, 0, 0),
-              gr::io_signature::make(1, 1, sizeof(uint8_t)))
+              gr::io_signature::make(0, 1, sizeof(uint8_t)))
     {
       m_mesDownId = mesDownId;
       m_sf = sf;
-      m_framelen =  framelen;
-      if( m_mesDownId < 0 && m_mesDownId >= ( 1 << sf ) ){
-        std::cout<<RED<<"MES ID is out of range: "<<m_mesDownId<<" sf: "<<m_sf<<std::endl;
-        exit(0);
+      m_framelen =  std::max<int>(framelen, 1);
+      m_stream_out = false;
+      if( sf < 12 && m_mesDownId >= ( 1 << sf ) ){
+        throw std::invalid_argument("mesCreater: the ID does not fit in one symbol");
       }
+      //a frame is written to the stream as a whole
+      set_output_multiple(m_framelen);
       m_outFile.open("msgCreaterRecord.txt",std::ios::out | std::ios::trunc);
       m_outFile<<"Id\tpayloadStr"<<std::endl;
+
+      // PDU mode: each message on "send" gives one frame on "pdu", without going through the stream
+      message_port_register_in(pmt::mp("send"));
+      message_port_register_out(pmt::mp("pdu"));
+      set_msg_handler(pmt::mp("send"), boost::bind(&mesCreater_impl::send_handler, this, _1));
     }
 
     /*
@@ -63,42 +73,61 @@ namespace gr {
       m_outFile.close();
     }
 
+    bool
+    mesCreater_impl::start()
+    {
+      //the frames go out on the stream if it is connected, as PDUs otherwise
+      m_stream_out = detail()->noutputs() > 0;
+      return block::start();
+    }
+
+    void
+    mesCreater_impl::send_handler(pmt::pmt_t msg)
+    {
+      //the message may carry the ID to send, otherwise the ID of the block goes
+      uint8_t id = pmt::is_integer(msg) ? (uint8_t)pmt::to_long(msg) : m_mesDownId;
+      if (m_stream_out) {
+        m_sendMes.push_back(id);
+        return;
+      }
+
+      //the ID in the first byte, the rest of the frame is zero
+      pmt::pmt_t payload = pmt::make_u8vector(m_framelen, 0);
+      size_t len;
+      pmt::u8vector_writable_elements(payload, len)[0] = id;
+      message_port_pub(pmt::mp("pdu"), pmt::cons(pmt::make_dict(), payload));
+    }
+
     void
-    mesCreater_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
+    mesCreater_impl::forecast (int /*noutput_items*/, gr_vector_int &/*ninput_items_required*/)
     {
       /* <+forecast+> e.g. ninput_items_required[0] = noutput_items */
     }
 
     int
     mesCreater_impl::general_work (int noutput_items,
-                       gr_vector_int &ninput_items,
-                       gr_vector_const_void_star &input_items,
+                       gr_vector_int &/*ninput_items*/,
+                       gr_vector_const_void_star &/*input_items*/,
                        gr_vector_void_star &output_items)
     {
-      const uint8_t *in = (const uint8_t *) input_items[0];
       uint8_t *out = (uint8_t *) output_items[0];
-      noutput_items = 0;
-      if(!m_sendMes){
-        return noutput_items;
+      if(m_sendMes.empty() || noutput_items < m_framelen){
+        return 0;
       }
 
-
-      pmt_t frame_len = pmt::from_long(framelen); //通过几个标点符号决定信标长度，一般由一个chirp决定
-      std::string payload_str;
-      payload_str.push(m_mesDownId);
-      m_outFile<<m_mesDownId<<"\t"<<(char)m_mesDownId<<std::endl;
+      pmt::pmt_t frame_len = pmt::from_long(m_framelen); //通过几个标点符号决定信标长度，一般由一个chirp决定
+      std::string payload_str(1, (char)m_sendMes.front());
+      m_outFile<<(int)m_sendMes.front()<<"\t"<<payload_str<<"\n";
       add_item_tag(0,nitems_written(0),pmt::string_to_symbol("frame_len"),frame_len);
       add_item_tag(0,nitems_written(0),pmt::string_to_symbol("payload_str"),pmt::string_to_symbol(payload_str));
 
-      //Id为32位数据，将32位数字转换为4个8进制数组进行传输
-      out[0] = m_mesDownId;
-      
-      noutput_items = frame_len;
-
-      consume_each (0);
+      //the ID in the first byte, the rest of the frame is zero as in the PDU
+      std::fill(out, out + m_framelen, 0);
+      out[0] = m_sendMes.front();
+      m_sendMes.pop_front();
 
       // Tell runtime system how many output items we produced.
-      return noutput_items;
+      return m_framelen;
     }
 
   } /* namespace CounterClockwiseAlarms */
@@ -24,6 +24,8 @@
 #include <CounterClockwiseAlarms/mesCreater.h>
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <deque>
 namespace gr {
   namespace CounterClockwiseAlarms {
 
@@ -35,10 +37,19 @@ namespace gr {
       uint8_t m_mesDownId;
       uint8_t m_framelen;
       std::ofstream m_outFile;
+      bool m_stream_out;             ///< the output is connected, frames go out on the stream and not as PDUs
+      std::deque<uint8_t> m_sendMes; ///< IDs requested on "send" and not yet written to the stream
+
+      /**
+       *  \brief  Publish a frame as a PDU, with the ID carried by the message if it is an integer.
+       */
+      void send_handler(pmt::pmt_t msg);
      public:
       mesCreater_impl(uint8_t mesDownId,uint8_t sf,uint8_t framelen);
       ~mesCreater_impl();
 
+      bool start();
+
       // Where all the action really happens
       void forecast (int noutput_items, gr_vector_int &ninput_items_required);
 
@@ -0,0 +1,143 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <volk/volk.h>
+#include "polyphase_decimator.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    static uint32_t gcd(uint32_t a, uint32_t b)
+    {
+        while (b) {
+            uint32_t t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    polyphase_decimator::polyphase_decimator(uint32_t in_rate, uint32_t out_rate, uint32_t nphases)
+      : m_frac(0), m_nphases(nphases), m_format(SAMPLE_FC32), m_in_scale(1)
+    {
+        uint32_t div = gcd(in_rate, out_rate);
+        m_decim = in_rate / div;
+        m_interp = out_rate / div;
+
+        double R = ratio();
+        // the anti aliasing filter spans 8 output samples
+        m_ntaps = 8 * (uint32_t)std::ceil(std::max(R, 1.0));
+        m_lead = m_ntaps / 2 - 1 + std::ceil(R / 2);
+
+        double fc = 0.5 / std::max(R, 1.0);
+        m_taps.resize((m_nphases + 1) * m_ntaps);
+        for (uint32_t p = 0; p <= m_nphases; p++) {
+            float *taps = &m_taps[p * m_ntaps];
+            double sum = 0;
+            for (uint32_t k = 0; k < m_ntaps; k++) {
+                // distance between the output instant and input sample k
+                double x = double(p) / m_nphases + m_ntaps / 2 - 1 - double(k);
+                double w = 0.54 + 0.46 * std::cos(2 * M_PI * x / m_ntaps);
+                double h = x == 0 ? 2 * fc : std::sin(2 * M_PI * fc * x) / (M_PI * x);
+                taps[k] = h * w;
+                sum += taps[k];
+            }
+            for (uint32_t k = 0; k < m_ntaps; k++)
+                taps[k] /= sum;
+        }
+    }
+
+    void polyphase_decimator::set_input_format(sample_format format, float full_scale)
+    {
+        m_format = format;
+        m_in_scale = 1.0f / (full_scale > 0 ? full_scale : default_full_scale(format));
+    }
+
+    int polyphase_decimator::input_needed(int noutput) const
+    {
+        return (int)std::ceil(m_lead + 1 + (noutput - 1 + 0.5) * ratio()) + m_ntaps / 2 + 1;
+    }
+
+    void polyphase_decimator::decimate(const void *in, gr_complex *out, int noutput, float delay) const
+    {
+        decimate(in, out, noutput, delay, m_frac);
+    }
+
+    void polyphase_decimator::decimate(const void *in, gr_complex *out, int noutput, float delay, uint32_t frac) const
+    {
+        if (m_format == SAMPLE_SC16)
+            return decimate_int(static_cast<const int16_t *>(in), out, noutput, delay, frac);
+        if (m_format == SAMPLE_SC8)
+            return decimate_int(static_cast<const int8_t *>(in), out, noutput, delay, frac);
+
+        const gr_complex *samples = static_cast<const gr_complex *>(in);
+        double R = ratio();
+        double t0 = m_lead + double(frac) / m_interp - delay * R;
+        for (int k = 0; k < noutput; k++) {
+            double t = t0 + k * R;
+            int i = (int)t;
+            uint32_t p = (uint32_t)std::lround((t - i) * m_nphases);
+            volk_32fc_32f_dot_prod_32fc(&out[k], &samples[i - (m_ntaps / 2 - 1)], &m_taps[p * m_ntaps], m_ntaps);
+        }
+    }
+
+    template <typename T>
+    void polyphase_decimator::decimate_int(const T *in, gr_complex *out, int noutput, float delay, uint32_t frac) const
+    {
+        double R = ratio();
+        double t0 = m_lead + double(frac) / m_interp - delay * R;
+        for (int k = 0; k < noutput; k++) {
+            double t = t0 + k * R;
+            int i = (int)t;
+            uint32_t p = (uint32_t)std::lround((t - i) * m_nphases);
+            const T *x = &in[2 * (i - (m_ntaps / 2 - 1))];
+            const float *taps = &m_taps[p * m_ntaps];
+            // m_ntaps is a multiple of 8, two accumulators per component break the dependency chain
+            float re0 = 0, im0 = 0, re1 = 0, im1 = 0;
+            for (uint32_t j = 0; j < m_ntaps; j += 2) {
+                re0 += taps[j] * x[2 * j];
+                im0 += taps[j] * x[2 * j + 1];
+                re1 += taps[j + 1] * x[2 * j + 2];
+                im1 += taps[j + 1] * x[2 * j + 3];
+            }
+            out[k] = gr_complex(re0 + re1, im0 + im1) * m_in_scale;
+        }
+    }
+
+    int polyphase_decimator::advance(int noutput)
+    {
+        return advance(noutput, m_frac);
+    }
+
+    int polyphase_decimator::advance(int noutput, uint32_t &frac) const
+    {
+        uint64_t pos = frac + uint64_t(noutput) * m_decim;
+        frac = pos % m_interp;
+        return pos / m_interp;
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_POLYPHASE_DECIMATOR_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_POLYPHASE_DECIMATOR_H
+
+#include <cstdint>
+#include <vector>
+#include <CounterClockwiseAlarms/dsp_complex.h>
+#include <CounterClockwiseAlarms/sample_format.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Polyphase low pass resampler bringing the input samples down to one sample per chip.
+     *
+     *  The ratio between the input and output rates can be any rational number. The output
+     *  instants are tracked exactly in units of 1/interp input samples, and every output uses
+     *  the filter phase closest to its fractional position, so a fractional delay (the STO)
+     *  costs nothing more than picking another phase. The filter is a windowed sinc cut at the
+     *  output Nyquist frequency, normalized to a unit DC gain.
+     *
+     *  Integer input samples are converted inside the filter: the dot products run on the raw
+     *  integers and only the output samples are scaled, so no float copy of the input is made.
+     */
+    class polyphase_decimator
+    {
+     public:
+      /**
+       *  \param  in_rate
+       *          The input sampling rate
+       *  \param  out_rate
+       *          The output sampling rate (the bandwidth)
+       *  \param  nphases
+       *          The number of fractional delays of the filter bank
+       */
+      polyphase_decimator(uint32_t in_rate, uint32_t out_rate, uint32_t nphases = 32);
+
+      /**
+       *  \brief  Number of input samples per output sample
+       */
+      double ratio() const { return double(m_decim)/m_interp; }
+
+      /**
+       *  \brief  Set the format of the input samples, SAMPLE_FC32 by default
+       *
+       *  \param  full_scale
+       *          The integer value of an amplitude of 1.0, 0 for default_full_scale(format)
+       */
+      void set_input_format(sample_format format, float full_scale = 0);
+
+      /**
+       *  \brief  Size in bytes of an input sample
+       */
+      size_t input_size() const { return sample_size(m_format); }
+
+      /**
+       *  \brief  Number of input samples needed to produce noutput samples with any delay in [-0.5, 0.5]
+       */
+      int input_needed(int noutput) const;
+
+      /**
+       *  \brief  Produce noutput samples starting at the current position of the time base.
+       *
+       *  \param  in
+       *          The input, at least input_needed(noutput) samples long, in the input format
+       *  \param  out
+       *          The output
+       *  \param  noutput
+       *          The number of samples to produce
+       *  \param  delay
+       *          Fractional advance of the output instants in output samples, within [-0.5, 0.5]
+       */
+      void decimate(const void *in, gr_complex *out, int noutput, float delay) const;
+
+      /**
+       *  \brief  Move the time base by noutput output samples.
+       *
+       *  \return The number of whole input samples the time base moved by, the fractional
+       *          remainder is kept for the next outputs
+       */
+      int advance(int noutput);
+
+      /**
+       *  \brief  Same as decimate(), on a time base kept by the caller, so that several readers
+       *          at different positions of the same input can share the filter bank.
+       *
+       *  \param  frac
+       *          The fractional part of the time base, in units of 1/interp input samples
+       */
+      void decimate(const void *in, gr_complex *out, int noutput, float delay, uint32_t frac) const;
+
+      /**
+       *  \brief  Same as advance(), on a time base kept by the caller
+       */
+      int advance(int noutput, uint32_t &frac) const;
+
+     private:
+      /**
+       *  \brief  decimate() on interleaved integer samples
+       */
+      template <typename T>
+      void decimate_int(const T *in, gr_complex *out, int noutput, float delay, uint32_t frac) const;
+
+      uint32_t m_interp;          ///< the ratio is m_decim/m_interp
+      uint32_t m_decim;           ///< the ratio is m_decim/m_interp
+      uint32_t m_frac;            ///< fractional part of the time base in units of 1/m_interp input samples
+      uint32_t m_nphases;         ///< number of filter phases
+      uint32_t m_ntaps;           ///< number of taps per phase
+      sample_format m_format;     ///< format of the input samples
+      float m_in_scale;           ///< amplitude of one unit of the integer input samples
+      double m_lead;              ///< input time of the first output without delay, leaves room for the filter and the delay
+      std::vector<float> m_taps;  ///< m_nphases+1 filters of m_ntaps taps, phase p delays by p/m_nphases samples
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_POLYPHASE_DECIMATOR_H */
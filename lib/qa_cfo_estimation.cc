@@ -0,0 +1,135 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <volk/volk.h>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "frame_sync_engine.h"
+#include "kiss_fft.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    struct frame_sync_engine_test
+    {
+        static float estimate_CFO(frame_sync_engine &sync, const gr_complex *preamble)
+        {
+            sync.estimate_CFO(preamble);
+            return sync.lambda_cfo;
+        }
+        static int preamble_symbols(const frame_sync_engine &sync) { return sync.up_symb_to_use; }
+    };
+
+    namespace {
+
+      const uint32_t bw = 125000;
+
+      /**
+       *  \brief  The fractional CFO as estimated before the zoom FFT: RCTSL on the zero
+       *          padded FFT, 2*nsymbols points per bin, of the whole dechirped preamble
+       */
+      double reference_CFO(const std::vector<gr_complex> &preamble, uint8_t sf, int nsymbols)
+      {
+          int nbins = 1 << sf;
+          int nfft = 2 * nsymbols * nbins;
+          std::vector<gr_complex> upchirp(nbins), downchirp(nbins);
+          gr::lora_sdr::build_ref_chirps(&upchirp[0], &downchirp[0], sf);
+
+          std::vector<kiss_fft_cpx> in(nfft), out(nfft);
+          for (int i = 0; i < nsymbols * nbins; i++) {
+              gr_complex d = preamble[i] * downchirp[i % nbins];
+              in[i].r = d.real();
+              in[i].i = d.imag();
+          }
+          kiss_fft_cfg cfg = kiss_fft_alloc(nfft, 0, NULL, NULL);
+          kiss_fft(cfg, &in[0], &out[0]);
+          kiss_fft_free(cfg);
+
+          std::vector<double> mag(nfft);
+          for (int i = 0; i < nfft; i++)
+              mag[i] = out[i].r * out[i].r + out[i].i * out[i].i;
+          int k0 = std::max_element(mag.begin(), mag.end()) - mag.begin();
+          double Y_1 = mag[gr::lora_sdr::mod(k0 - 1, nfft)];
+          double Y0 = mag[k0];
+          double Y1 = mag[gr::lora_sdr::mod(k0 + 1, nfft)];
+          double u = 64 * nbins / 406.5506497;
+          double v = u * 2.4674;
+          double wa = (Y1 - Y_1) / (u * (Y1 + Y_1) + v * Y0);
+          double ka = wa * nbins / M_PI;
+          double k_residual = fmod((k0 + ka) / 2 / nsymbols, 1);
+          return k_residual - (k_residual > 0.5 ? 1 : 0);
+      }
+
+      /**
+       *  \brief  Preamble upchirps of value id, with a fractional CFO and some noise
+       */
+      std::vector<gr_complex> make_preamble(uint8_t sf, int nsymbols, uint32_t id, double cfo, float noise, std::mt19937 &rng)
+      {
+          int nbins = 1 << sf;
+          std::vector<gr_complex> samples(nsymbols * nbins);
+          for (int s = 0; s < nsymbols; s++)
+              gr::lora_sdr::build_upchirp(&samples[s * nbins], id, sf);
+          gr_complex phase(1, 0);
+          volk_32fc_s32fc_x2_rotator_32fc(&samples[0], &samples[0], expj(2 * M_PI * cfo / nbins), &phase, samples.size());
+          std::normal_distribution<float> gauss(0, noise);
+          for (size_t i = 0; i < samples.size(); i++)
+              samples[i] += gr_complex(gauss(rng), gauss(rng));
+          return samples;
+      }
+
+      void check_against_reference(uint8_t sf)
+      {
+          frame_sync_engine sync(bw, bw, sf, std::vector<uint16_t>(1, 0x12));
+          int nsymbols = frame_sync_engine_test::preamble_symbols(sync);
+          std::mt19937 rng(sf);
+          std::uniform_int_distribution<uint32_t> ids(0, (1u << sf) - 1);
+          //the zoom sums the samples by blocks before evaluating the three lines, which
+          //weighs the noise slightly differently: the estimates drift apart as the SNR drops
+          const float noise = 0.05f;
+          const double cfos[] = {-0.45, -0.3, -0.1, 0, 0.05, 0.25, 0.4};
+          for (double cfo : cfos) {
+              for (int trial = 0; trial < 4; trial++) {
+                  std::vector<gr_complex> preamble = make_preamble(sf, nsymbols, ids(rng), cfo, noise, rng);
+                  double expected = reference_CFO(preamble, sf, nsymbols);
+                  float lambda = frame_sync_engine_test::estimate_CFO(sync, &preamble[0]);
+                  BOOST_CHECK_SMALL(lambda - expected, 1e-5);
+                  BOOST_CHECK_SMALL(lambda - cfo, 0.05);
+              }
+          }
+      }
+
+    } // namespace
+
+    BOOST_AUTO_TEST_CASE(test_cfo_estimation_sf7)
+    {
+        check_against_reference(7);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_cfo_estimation_sf9)
+    {
+        check_against_reference(9);
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,199 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "chirp_nco.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    namespace {
+
+      const uint32_t bw = 125000;
+
+      /**
+       *  \brief  Chirp segment of a waveform, in quarters of a symbol
+       */
+      struct segment
+      {
+          int id;       ///< symbol value of an upchirp, -1 for the downchirp
+          int quarters; ///< duration
+      };
+
+      /**
+       *  \brief  The segments, one after the other, as a continuous phase waveform sampled at
+       *          samp_rate from the start of the first one. The phase is computed in double
+       *          from the time since the segment start, with no accumulation.
+       */
+      std::vector<gr_complex> reference(uint8_t sf, uint32_t samp_rate, const std::vector<segment> &segments)
+      {
+          double nbins = 1 << sf;
+          double symbol = nbins/bw;
+          std::vector<gr_complex> samples;
+          double start = 0;
+          double phase = 0;
+          for (size_t s = 0; s < segments.size(); s++) {
+              double duration = symbol*segments[s].quarters/4;
+              double id = segments[s].id;
+              //phase after t seconds of the segment, the frequency folding at the band edge
+              auto phi = [&](double t) {
+                  if (id < 0)
+                      return 2*M_PI*bw*(0.5*t - t*t/(2*symbol));
+                  double fold = (1 - id/nbins)*symbol;
+                  return 2*M_PI*bw*((id/nbins - 0.5)*t + t*t/(2*symbol) - (t > fold ? t - fold : 0));
+              };
+              for (uint64_t n = std::ceil(start*samp_rate - 1e-9); n < (start + duration)*samp_rate - 1e-9; n++)
+                  samples.push_back(expj(phase + phi(n/double(samp_rate) - start)));
+              phase += phi(duration);
+              start += duration;
+          }
+          return samples;
+      }
+
+      std::vector<gr_complex> synthesize(chirp_nco &nco, const std::vector<segment> &segments)
+      {
+          std::vector<gr_complex> samples;
+          std::vector<gr_complex> buffer(nco.max_samples());
+          for (size_t s = 0; s < segments.size(); s++) {
+              int n = segments[s].id < 0 ? nco.downchirp(&buffer[0], segments[s].quarters)
+                                         : nco.upchirp(&buffer[0], segments[s].id, segments[s].quarters);
+              samples.insert(samples.end(), buffer.begin(), buffer.begin() + n);
+          }
+          return samples;
+      }
+
+      /**
+       *  \brief  Largest distance between the samples and the reference, once the constant
+       *          phase offset between them is removed
+       */
+      double max_error(const std::vector<gr_complex> &samples, const std::vector<gr_complex> &ref)
+      {
+          gr_complex corr(0, 0);
+          for (size_t i = 0; i < samples.size(); i++)
+              corr += samples[i]*std::conj(ref[i]);
+          gr_complex rotation = corr/std::abs(corr);
+          double error = 0;
+          for (size_t i = 0; i < samples.size(); i++)
+              error = std::max(error, (double)std::abs(samples[i] - rotation*ref[i]));
+          return error;
+      }
+
+      //a frame start: upchirps of several values, then the quarter downchirp, then more upchirps
+      const std::vector<segment> frame = {{0, 4}, {0, 4}, {37, 4}, {-1, 4}, {-1, 1}, {200, 4}, {255, 4}, {1, 4}};
+
+    } // namespace
+
+    BOOST_AUTO_TEST_CASE(test_chirp_nco_integer_ratio)
+    {
+      chirp_nco nco(8, 4*bw, bw);
+      std::vector<gr_complex> samples = synthesize(nco, frame);
+      std::vector<gr_complex> ref = reference(8, 4*bw, frame);
+      BOOST_REQUIRE_EQUAL(samples.size(), ref.size());
+      BOOST_CHECK_SMALL(max_error(samples, ref), 1e-3);
+
+      //the upchirps are those of build_upchirp, whose phase restarts at each symbol
+      std::vector<gr_complex> chirp(4*256);
+      lora_sdr::build_upchirp(&chirp[0], 37, 8, 4);
+      std::vector<gr_complex> symbol(samples.begin() + 2*4*256, samples.begin() + 3*4*256);
+      BOOST_CHECK_SMALL(max_error(symbol, chirp), 1e-3);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_chirp_nco_fractional_ratio)
+    {
+      //2.4 samples per chip: a symbol is 614.4 samples long
+      const uint32_t samp_rate = 300000;
+      chirp_nco nco(8, samp_rate, bw);
+      BOOST_CHECK_EQUAL(nco.samples(4), 615);
+      BOOST_CHECK_EQUAL(nco.samples(5*4), 3072);
+      BOOST_CHECK_EQUAL(nco.samples(5*4+1), 3226);
+
+      //the symbol boundaries don't drift and the phase goes on from one symbol to the next
+      std::vector<gr_complex> samples = synthesize(nco, frame);
+      std::vector<gr_complex> ref = reference(8, samp_rate, frame);
+      BOOST_REQUIRE_EQUAL(samples.size(), ref.size());
+      BOOST_CHECK_SMALL(max_error(samples, ref), 1e-3);
+
+      //after restart() the boundaries start over at the next sample, the phase goes on
+      nco.restart();
+      samples = synthesize(nco, frame);
+      BOOST_REQUIRE_EQUAL(samples.size(), ref.size());
+      BOOST_CHECK_SMALL(max_error(samples, ref), 1e-3);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_chirp_nco_long_symbols)
+    {
+      //at SF12 and 8x or more a symbol is tens of thousands of samples: the float rotations
+      //must not drift in amplitude, which the integer formats would clip, nor in phase
+      const uint32_t samp_rates[] = {1000000, 2000000, 2400000, 4000000};
+      const std::vector<segment> symbols = {{0, 4}, {1234, 4}, {-1, 1}, {4095, 4}};
+      for (uint32_t samp_rate : samp_rates) {
+          BOOST_TEST_MESSAGE("samp_rate " << samp_rate);
+          chirp_nco nco(12, samp_rate, bw);
+          std::vector<gr_complex> samples = synthesize(nco, symbols);
+          std::vector<gr_complex> ref = reference(12, samp_rate, symbols);
+          BOOST_REQUIRE_EQUAL(samples.size(), ref.size());
+          float envelope = 0;
+          for (size_t i = 0; i < samples.size(); i++)
+              envelope = std::max(envelope, std::fabs(std::abs(samples[i]) - 1));
+          BOOST_CHECK_SMALL(envelope, 1e-3f);
+          BOOST_CHECK_SMALL(max_error(samples, ref), 1e-3);
+      }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_chirp_nco_integer_formats)
+    {
+      //the integer samples are the float ones scaled, the full scale of SC8 beyond its range
+      const sample_format formats[] = {SAMPLE_SC16, SAMPLE_SC8};
+      const float full_scales[] = {20000, 200};
+      const float limits[] = {32767, 127};
+      for (int f = 0; f < 2; f++) {
+          chirp_nco fc32(8, 300000, bw), nco(8, 300000, bw);
+          nco.set_output_format(formats[f], full_scales[f]);
+          BOOST_REQUIRE_EQUAL(nco.output_size(), sample_size(formats[f]));
+
+          std::vector<gr_complex> expected(fc32.max_samples());
+          std::vector<int16_t> out16(2*nco.max_samples());
+          std::vector<int8_t> out8(2*nco.max_samples());
+          float error = 0, peak = 0;
+          for (int s = 0; s < 6; s++) {
+              int n = fc32.upchirp(&expected[0], 37*s);
+              int m = formats[f] == SAMPLE_SC16 ? nco.upchirp(&out16[0], 37*s) : nco.upchirp(&out8[0], 37*s);
+              BOOST_REQUIRE_EQUAL(m, n);
+              const float *components = reinterpret_cast<const float *>(&expected[0]);
+              for (int i = 0; i < 2*n; i++) {
+                  float value = formats[f] == SAMPLE_SC16 ? out16[i] : out8[i];
+                  float scaled = std::max(-limits[f] - 1, std::min(limits[f], components[i]*full_scales[f]));
+                  error = std::max(error, std::fabs(value - scaled));
+                  peak = std::max(peak, std::fabs(value));
+              }
+          }
+          //within the rounding, and SC8 saturates instead of wrapping around
+          BOOST_CHECK_LE(error, 1.0f);
+          if (formats[f] == SAMPLE_SC8)
+              BOOST_CHECK_EQUAL(peak, 128.0f);
+      }
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
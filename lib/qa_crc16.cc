@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "crc16.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    namespace {
+
+      /**
+       *  \brief  CRC-16/MODBUS one bit at a time, as crcAppend computed it before the tables
+       */
+      uint16_t bitwise_crc(const uint8_t *data, size_t len)
+      {
+        uint16_t crc = 0xffff;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+        return crc;
+      }
+
+      std::vector<uint8_t> random_bytes(size_t len, std::mt19937 &gen)
+      {
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::vector<uint8_t> data(len);
+        for (size_t i = 0; i < len; i++)
+            data[i] = byte(gen);
+        return data;
+      }
+
+    } // namespace
+
+    BOOST_AUTO_TEST_CASE(test_crc16_check_value)
+    {
+      //the check value of CRC-16/MODBUS
+      const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+      BOOST_CHECK_EQUAL(crc16::compute(check, sizeof(check)), 0x4B37);
+      BOOST_CHECK_EQUAL(crc16::compute(check, 0), 0xFFFF);
+
+      std::mt19937 gen(0);
+      //every length, so that the 8 bytes steps and the tail are both covered
+      for (size_t len = 1; len < 40; len++) {
+          std::vector<uint8_t> data = random_bytes(len, gen);
+          BOOST_CHECK_EQUAL(crc16::compute(&data[0], len), bitwise_crc(&data[0], len));
+      }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_crc16_incremental)
+    {
+      //the bytes fed in random pieces, as they come through work calls, give the CRC of the whole
+      std::mt19937 gen(1);
+      std::uniform_int_distribution<size_t> piece(0, 20);
+      for (int trial = 0; trial < 200; trial++) {
+          std::vector<uint8_t> data = random_bytes(1 + gen() % 3000, gen);
+          crc16 crc;
+          for (size_t i = 0; i < data.size();) {
+              size_t n = std::min(piece(gen), data.size() - i);
+              if (n == 1)
+                  crc.update(data[i]);
+              else
+                  crc.update(&data[i], n);
+              i += n;
+          }
+          BOOST_CHECK_EQUAL(crc.value(), crc16::compute(&data[0], data.size()));
+
+          crc.reset();
+          crc.update(&data[0], data.size());
+          BOOST_CHECK_EQUAL(crc.value(), crc16::compute(&data[0], data.size()));
+      }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_crc16_residue)
+    {
+      //the CRC of a message followed by its CRC, low byte first, is 0: what Crc_verif checks
+      std::mt19937 gen(2);
+      for (size_t len = 1; len < 64; len++) {
+          std::vector<uint8_t> data = random_bytes(len, gen);
+          uint16_t crc = crc16::compute(&data[0], len);
+          data.push_back(crc & 0xff);
+          data.push_back(crc >> 8);
+          BOOST_CHECK_EQUAL(crc16::compute(&data[0], data.size()), 0);
+
+          //a single bit error is always caught
+          data[gen() % data.size()] ^= 1 << (gen() % 8);
+          BOOST_CHECK_NE(crc16::compute(&data[0], data.size()), 0);
+      }
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
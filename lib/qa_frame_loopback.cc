@@ -0,0 +1,205 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <vector>
+#include <CounterClockwiseAlarms/utilities.h>
+#include "chirp_table.h"
+#include "crc16.h"
+#include "frame_modulator.h"
+#include "frame_sync_engine.h"
+#include "symbol_demod.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    namespace {
+
+      const uint32_t bw = 125000;
+
+      /**
+       *  \brief  Modulate alarm frames, the ID followed by its CRC, as crcAppend and DownModulate send them
+       *
+       *  \return The samples, with noise, silence before the first frame and padding after each frame
+       */
+      std::vector<gr_complex> transmit(uint8_t sf, uint32_t samp_rate, const std::vector<uint8_t> &ids)
+      {
+        frame_modulator modulator(sf, samp_rate, bw, std::vector<uint16_t>(1, 0x12));
+        modulator.set_inter_frame_padding(3);
+        for (size_t i = 0; i < ids.size(); i++) {
+            uint8_t frame[3] = {ids[i]};
+            uint16_t crc = crc16::compute(frame, 1);
+            frame[1] = crc & 0xff;
+            frame[2] = crc >> 8;
+            modulator.push(frame, 3);
+        }
+
+        int lead = 2000;
+        std::vector<gr_complex> samples(lead + ids.size()*modulator.frame_samples(3));
+        std::vector<frame_position> frames;
+        int nsamples = lead;
+        //small output buffers, as a block gets them
+        while (modulator.pending())
+            nsamples += modulator.output(&samples[nsamples], std::min<int>(1000, samples.size()-nsamples), frames);
+        BOOST_REQUIRE_EQUAL(nsamples, (int)samples.size());
+
+        std::mt19937 gen(sf);
+        std::normal_distribution<float> noise(0, 0.05);
+        for (size_t i = 0; i < samples.size(); i++)
+            samples[i] += gr_complex(noise(gen), noise(gen));
+        return samples;
+      }
+
+      /**
+       *  \brief  Receive the frames as AlarmReceiver does: synchronize, then demodulate each
+       *          symbol against the downchirp shifted by the integer CFO of its frame
+       *
+       *  \param  chunk
+       *          The number of input samples given to each work call
+       *  \param  max_symbols
+       *          The number of symbols the engine may output per work call
+       *  \return The symbols of each frame
+       */
+      std::vector<std::vector<uint8_t> > receive(const std::vector<gr_complex> &samples, uint8_t sf, uint32_t samp_rate,
+                                                 int chunk, int max_symbols)
+      {
+        uint32_t nbins = 1u << sf;
+        frame_sync_engine sync(samp_rate, bw, sf, std::vector<uint16_t>(1, 0x12));
+        sync.set_symb_numb(3);
+        std::unique_ptr<symbol_demodulator> demod = symbol_demodulator::make(sf);
+        const chirp_table &chirps = chirp_table::get(sf);
+
+        std::vector<gr_complex> symbols(max_symbols*nbins);
+        std::vector<gr_complex> downchirp(nbins);
+        std::vector<frame_start> starts;
+        std::vector<std::vector<uint8_t> > frames;
+        size_t base = 0;
+        while (base + sync.window_len() <= samples.size()) {
+            int ninput = std::min<size_t>(chunk, samples.size()-base);
+            int consumed;
+            starts.clear();
+            int nsymbols = sync.work(&samples[base], ninput, &symbols[0], max_symbols, consumed, starts);
+            size_t start = 0;
+            for (int i = 0; i < nsymbols; i++) {
+                if (start < starts.size() && starts[start].out_index == i) {
+                    chirps.upchirp(&downchirp[0], lora_sdr::mod(starts[start].cfo_int, nbins));
+                    for (uint32_t n = 0; n < nbins; n++)
+                        downchirp[n] = std::conj(downchirp[n]);
+                    frames.push_back(std::vector<uint8_t>());
+                    start++;
+                }
+                demod_result res;
+                demod->demod(&symbols[i*nbins], &downchirp[0], res);
+                BOOST_REQUIRE(!frames.empty());
+                frames.back().push_back(res.bin);
+            }
+            base += consumed;
+            //the last chunk is too short for another symbol window
+            if (!consumed && !nsymbols && ninput == (int)(samples.size()-base))
+                break;
+        }
+        return frames;
+      }
+
+      /**
+       *  \brief  Add a frame carrying the given symbols to samples, at a sample offset, with a
+       *          gain and a carrier offset in bins
+       */
+      void add_frame(std::vector<gr_complex> &samples, uint8_t sf, uint32_t samp_rate, const std::vector<uint8_t> &payload,
+                     size_t offset, float gain, double cfo)
+      {
+        frame_modulator modulator(sf, samp_rate, bw, std::vector<uint16_t>(1, 0x12));
+        std::vector<gr_complex> frame(modulator.frame_samples(payload.size()));
+        modulator.write_frame(&payload[0], payload.size(), &frame[0]);
+        BOOST_REQUIRE_LE(offset + frame.size(), samples.size());
+        double step = 2*M_PI*cfo*bw/(1u << sf)/samp_rate;
+        for (size_t i = 0; i < frame.size(); i++)
+            samples[offset+i] += gain*frame[i]*expj(step*i);
+      }
+
+      void check_frames(const std::vector<std::vector<uint8_t> > &frames, const std::vector<uint8_t> &ids)
+      {
+        BOOST_REQUIRE_EQUAL(frames.size(), ids.size());
+        for (size_t i = 0; i < ids.size(); i++) {
+            BOOST_REQUIRE_EQUAL(frames[i].size(), 3u);
+            BOOST_CHECK_EQUAL(frames[i][0], ids[i]);
+            //the CRC of the ID followed by its CRC is 0
+            BOOST_CHECK_EQUAL(crc16::compute(&frames[i][0], 3), 0);
+        }
+      }
+
+    } // namespace
+
+    BOOST_AUTO_TEST_CASE(test_frame_loopback_sf8)
+    {
+      std::vector<uint8_t> ids = {42, 7, 200, 255};
+      std::vector<gr_complex> samples = transmit(8, 4*bw, ids);
+      check_frames(receive(samples, 8, 4*bw, 3000, 16), ids);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_frame_loopback_split_output)
+    {
+      //one symbol per call, a frame is output over several work calls
+      std::vector<uint8_t> ids = {42, 7, 200};
+      std::vector<gr_complex> samples = transmit(8, 4*bw, ids);
+      check_frames(receive(samples, 8, 4*bw, 3000, 1), ids);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_frame_loopback_fractional_rate)
+    {
+      //2.4 samples per chip, the rate of many SDRs for a 125 kHz band
+      std::vector<uint8_t> ids = {42, 7, 200, 255, 128};
+      std::vector<gr_complex> samples = transmit(8, 300000, ids);
+      check_frames(receive(samples, 8, 300000, 3000, 16), ids);
+      //odd input chunks and one symbol per call
+      check_frames(receive(samples, 8, 300000, 777, 1), ids);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_frame_collision_sf7)
+    {
+      //the second frame starts during the first one, 2 dB weaker and at another carrier
+      //offset, from the end of the preamble of the first frame onward. The symbols are kept
+      //under 128, SF7 can't carry the CRC of every ID.
+      const uint8_t sf = 7;
+      const uint32_t samp_rate = 4*bw;
+      const int symbol = (1 << sf)*samp_rate/bw;
+      std::vector<uint8_t> first = {17, 90, 3};
+      std::vector<uint8_t> second = {64, 5, 120};
+      const double starts[] = {7.6, 9.3, 11.5, 12.8, 14.1, 15.4};
+      for (double start : starts) {
+        BOOST_TEST_MESSAGE("second frame at symbol " << start);
+        std::vector<gr_complex> samples(40*symbol);
+        std::mt19937 gen(lround(start*10));
+        std::normal_distribution<float> noise(0, 0.05);
+        for (size_t i = 0; i < samples.size(); i++)
+            samples[i] = gr_complex(noise(gen), noise(gen));
+        add_frame(samples, sf, samp_rate, first, 2*symbol, 1, -0.7);
+        add_frame(samples, sf, samp_rate, second, 2*symbol + lround(start*symbol), std::pow(10, -2/20.), 2.3);
+
+        std::vector<std::vector<uint8_t> > frames = receive(samples, sf, samp_rate, 3000, 16);
+        BOOST_REQUIRE_EQUAL(frames.size(), 2u);
+        BOOST_CHECK(frames[0] == first);
+        BOOST_CHECK(frames[1] == second);
+      }
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include "spsc_ring.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    BOOST_AUTO_TEST_CASE(test_spsc_ring_capacity)
+    {
+        spsc_ring<int> ring(1000);
+        BOOST_CHECK_EQUAL(ring.capacity(), 1024u);
+
+        //a full ring drops and counts the items pushed
+        for (int i = 0; i < 1024; i++)
+            BOOST_CHECK(ring.push(i));
+        BOOST_CHECK(!ring.push(1024));
+        BOOST_CHECK(!ring.push(1025));
+        BOOST_CHECK_EQUAL(ring.dropped(), 2u);
+
+        //the oldest items come out first, the index wraps around
+        int out[1024];
+        BOOST_CHECK_EQUAL(ring.pop(out, 10), 10u);
+        for (int i = 0; i < 10; i++)
+            BOOST_CHECK_EQUAL(out[i], i);
+        for (int i = 0; i < 10; i++)
+            BOOST_CHECK(ring.push(2000 + i));
+        BOOST_CHECK_EQUAL(ring.pop(out, 1024), 1024u);
+        BOOST_CHECK_EQUAL(out[0], 10);
+        BOOST_CHECK_EQUAL(out[1013], 1023);
+        BOOST_CHECK_EQUAL(out[1023], 2009);
+        BOOST_CHECK_EQUAL(ring.pop(out, 1024), 0u);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_spsc_ring_threads)
+    {
+        //the consumer sees every item, in order, while the producer keeps pushing
+        const uint64_t n_items = 1000000;
+        spsc_ring<uint64_t> ring(256);
+        std::thread producer([&ring, n_items]() {
+            for (uint64_t i = 0; i < n_items; i++)
+                while (!ring.push(i))
+                    std::this_thread::yield();
+        });
+
+        uint64_t out[64];
+        uint64_t next = 0;
+        bool in_order = true;
+        while (next < n_items) {
+            size_t n = ring.pop(out, 64);
+            for (size_t i = 0; i < n; i++)
+                in_order &= out[i] == next++;
+            if (!n)
+                std::this_thread::yield();
+        }
+        producer.join();
+
+        BOOST_CHECK(in_order);
+        BOOST_CHECK_EQUAL(next, n_items);
+        BOOST_CHECK_EQUAL(ring.pop(out, 64), 0u);
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
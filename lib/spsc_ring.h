@@ -0,0 +1,115 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_SPSC_RING_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Bounded lock-free queue between one producer thread and one consumer thread.
+     *
+     *  push() never blocks nor allocates: when the ring is full the item is dropped and
+     *  counted, so the producer (a work function) is never slowed down by a late consumer.
+     */
+    template <typename T>
+    class spsc_ring
+    {
+     public:
+      /**
+       *  \param  capacity
+       *          The number of items the ring can hold, rounded up to a power of 2
+       */
+      explicit spsc_ring(size_t capacity)
+        : m_head(0), m_tail(0), m_dropped(0)
+      {
+          size_t size = 1;
+          while (size < capacity)
+              size <<= 1;
+          m_mask = size - 1;
+          m_items.resize(size);
+      }
+
+      /**
+       *  \brief  Append an item, from the producer thread only.
+       *
+       *  \return false if the ring was full and the item dropped
+       */
+      bool push(const T &item)
+      {
+          size_t head = m_head.load(std::memory_order_relaxed);
+          if (head - m_tail.load(std::memory_order_acquire) > m_mask) {
+              m_dropped.fetch_add(1, std::memory_order_relaxed);
+              return false;
+          }
+          m_items[head & m_mask] = item;
+          m_head.store(head + 1, std::memory_order_release);
+          return true;
+      }
+
+      /**
+       *  \brief  Take the oldest items, from the consumer thread only.
+       *
+       *  \param  out
+       *          Where to copy the items
+       *  \param  max_items
+       *          The maximum number of items to take
+       *  \return The number of items taken
+       */
+      size_t pop(T *out, size_t max_items)
+      {
+          size_t tail = m_tail.load(std::memory_order_relaxed);
+          size_t n = std::min(max_items, m_head.load(std::memory_order_acquire) - tail);
+          for (size_t i = 0; i < n; i++)
+              out[i] = m_items[(tail + i) & m_mask];
+          m_tail.store(tail + n, std::memory_order_release);
+          return n;
+      }
+
+      /**
+       *  \brief  Number of items dropped because the ring was full
+       */
+      uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+      size_t capacity() const { return m_mask + 1; }
+
+     private:
+      size_t m_mask;                    ///< capacity-1, the capacity being a power of 2
+      std::vector<T> m_items;           ///< storage
+      //the padding keeps the two indices on their own cache lines, so that the threads don't share one
+      char m_pad0[64];
+      std::atomic<size_t> m_head;       ///< number of items pushed, written by the producer
+      char m_pad1[64];
+      std::atomic<size_t> m_tail;       ///< number of items popped, written by the consumer
+      char m_pad2[64];
+      std::atomic<uint64_t> m_dropped;  ///< number of items dropped by push
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_SPSC_RING_H */
@@ -0,0 +1,162 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <new>
+#include <volk/volk.h>
+#include "fft_plan_cache.h"
+#include "symbol_demod.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    void demod_symbol(const gr_complex *samples, const gr_complex *ref_chirp, uint32_t nfft,
+                      kiss_fft_cfg cfg, kiss_fft_cpx *fft_in, kiss_fft_cpx *fft_out,
+                      demod_result &res)
+    {
+        gr_complex *dechirped = reinterpret_cast<gr_complex *>(fft_in);
+        const gr_complex *spectrum = reinterpret_cast<const gr_complex *>(fft_out);
+        gr_complex sig_en;
+
+        volk_32fc_x2_multiply_32fc(dechirped, samples, ref_chirp, nfft);
+        // the unnormalized FFT scales the energy by nfft
+        volk_32fc_x2_conjugate_dot_prod_32fc(&sig_en, dechirped, dechirped, nfft);
+        res.total_energy = sig_en.real() * nfft;
+
+        kiss_fft(cfg, fft_in, fft_out);
+
+        volk_32fc_index_max_32u(&res.bin, spectrum, nfft);
+        res.peak_energy = std::norm(spectrum[res.bin]);
+    }
+
+    void *symbol_demodulator::operator new(size_t size)
+    {
+        void *ptr = volk_malloc(size, 64);
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void symbol_demodulator::operator delete(void *ptr)
+    {
+        volk_free(ptr);
+    }
+
+    namespace {
+
+      /**
+       *  \brief  Kernel of a spreading factor known at compile time
+       */
+      template <uint8_t SF>
+      class sf_symbol_demodulator : public symbol_demodulator
+      {
+       public:
+        static const uint32_t N = 1u << SF;
+
+        sf_symbol_demodulator() : m_cfg(fft_plan_cache::instance().get(N)) {}
+
+        void demod(const gr_complex *samples, const gr_complex *ref_chirp, demod_result &res)
+        {
+            const float *x = reinterpret_cast<const float *>(samples);
+            const float *c = reinterpret_cast<const float *>(ref_chirp);
+            // dechirp and measure the energy in the same pass, with enough partial sums for
+            // the compiler to keep them in one vector register
+            float energy[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+            for (uint32_t n = 0; n < N; n += 8) {
+                for (uint32_t k = 0; k < 8; k++) {
+                    float re = x[2 * (n + k)] * c[2 * (n + k)] - x[2 * (n + k) + 1] * c[2 * (n + k) + 1];
+                    float im = x[2 * (n + k)] * c[2 * (n + k) + 1] + x[2 * (n + k) + 1] * c[2 * (n + k)];
+                    m_in[n + k].r = re;
+                    m_in[n + k].i = im;
+                    energy[k] += re * re + im * im;
+                }
+            }
+            float sum = 0;
+            for (uint32_t k = 0; k < 8; k++)
+                sum += energy[k];
+            // the unnormalized FFT scales the energy by N
+            res.total_energy = sum * N;
+
+            kiss_fft(m_cfg, m_in.data(), m_out.data());
+
+            volk_32fc_index_max_32u(&res.bin, spectrum(), N);
+            res.peak_energy = std::norm(spectrum()[res.bin]);
+        }
+
+        const gr_complex *spectrum() const { return reinterpret_cast<const gr_complex *>(m_out.data()); }
+
+        uint32_t nfft() const { return N; }
+
+       private:
+        kiss_fft_cfg m_cfg;                             ///< FFT plan, borrowed from fft_plan_cache
+        alignas(64) std::array<kiss_fft_cpx, N> m_in;   ///< dechirped symbol
+        alignas(64) std::array<kiss_fft_cpx, N> m_out;  ///< spectrum of the dechirped symbol
+      };
+
+      /**
+       *  \brief  Kernel of any spreading factor
+       */
+      class generic_symbol_demodulator : public symbol_demodulator
+      {
+       public:
+        explicit generic_symbol_demodulator(uint8_t sf)
+          : m_nfft(1u << sf), m_cfg(fft_plan_cache::instance().get(m_nfft))
+        {
+            m_in.resize(m_nfft);
+            m_out.resize(m_nfft);
+        }
+
+        void demod(const gr_complex *samples, const gr_complex *ref_chirp, demod_result &res)
+        {
+            demod_symbol(samples, ref_chirp, m_nfft, m_cfg, m_in.data(), m_out.data(), res);
+        }
+
+        const gr_complex *spectrum() const { return reinterpret_cast<const gr_complex *>(m_out.data()); }
+
+        uint32_t nfft() const { return m_nfft; }
+
+       private:
+        uint32_t m_nfft;        ///< Number of samples per symbol
+        kiss_fft_cfg m_cfg;     ///< FFT plan, borrowed from fft_plan_cache
+        fft_buffer m_in;        ///< dechirped symbol
+        fft_buffer m_out;       ///< spectrum of the dechirped symbol
+      };
+
+    } // anonymous namespace
+
+    std::unique_ptr<symbol_demodulator> symbol_demodulator::make(uint8_t sf)
+    {
+        switch (sf) {
+        case 7:  return std::unique_ptr<symbol_demodulator>(new sf_symbol_demodulator<7>());
+        case 8:  return std::unique_ptr<symbol_demodulator>(new sf_symbol_demodulator<8>());
+        case 9:  return std::unique_ptr<symbol_demodulator>(new sf_symbol_demodulator<9>());
+        case 10: return std::unique_ptr<symbol_demodulator>(new sf_symbol_demodulator<10>());
+        case 11: return std::unique_ptr<symbol_demodulator>(new sf_symbol_demodulator<11>());
+        case 12: return std::unique_ptr<symbol_demodulator>(new sf_symbol_demodulator<12>());
+        default: return std::unique_ptr<symbol_demodulator>(new generic_symbol_demodulator(sf));
+        }
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_SYMBOL_DEMOD_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_SYMBOL_DEMOD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <CounterClockwiseAlarms/dsp_complex.h>
+#include "kiss_fft.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Result of the demodulation of one lora symbol
+     */
+    struct demod_result
+    {
+        uint32_t bin;       ///< index of the strongest bin of the dechirped spectrum
+        float peak_energy;  ///< squared magnitude of that bin
+        float total_energy; ///< sum of the squared magnitudes of all the bins
+    };
+
+    /**
+     *  \brief  Dechirp a symbol, take its FFT and return its argmax, peak and total energy.
+     *
+     *          The dechirped samples are written straight into the FFT input (kiss_fft_cpx has
+     *          the layout of gr_complex), the total energy is taken from the dechirped samples
+     *          with Parseval's theorem while they are still in cache, and the argmax runs on the
+     *          FFT output without building a magnitude vector. All three passes are volk kernels,
+     *          so the SIMD implementation (SSE, AVX2, AVX512, NEON...) is picked at runtime.
+     *
+     *  \param  samples
+     *          The pointer to the symbol beginning
+     *  \param  ref_chirp
+     *          The reference chirp used to dechirp the symbol
+     *  \param  nfft
+     *          The number of samples of the symbol, and size of the FFT
+     *  \param  cfg
+     *          The FFT plan of size nfft
+     *  \param  fft_in
+     *          Scratch buffer of nfft elements receiving the dechirped symbol
+     *  \param  fft_out
+     *          Scratch buffer of nfft elements receiving the spectrum
+     *  \param  res
+     *          The demodulation result
+     */
+    void demod_symbol(const gr_complex *samples, const gr_complex *ref_chirp, uint32_t nfft,
+                      kiss_fft_cfg cfg, kiss_fft_cpx *fft_in, kiss_fft_cpx *fft_out,
+                      demod_result &res);
+
+    /**
+     *  \brief  Demodulator of the symbols of one spreading factor, owning its scratch buffers.
+     *
+     *          make() returns a kernel compiled for the spreading factor when it is between 7
+     *          and 12: the symbol length is then a compile time constant, the scratch buffers
+     *          are fixed size arrays aligned for any SIMD width, and the dechirping and energy
+     *          loops have a fixed trip count the compiler vectorizes. Other spreading factors
+     *          get a kernel built on demod_symbol().
+     */
+    class symbol_demodulator
+    {
+     public:
+      virtual ~symbol_demodulator() {}
+
+      /**
+       *  \brief  Return the demodulator of the symbols of sf
+       */
+      static std::unique_ptr<symbol_demodulator> make(uint8_t sf);
+
+      /**
+       *  \brief  Same as demod_symbol(), with the scratch buffers of the demodulator
+       *
+       *  \param  samples
+       *          The pointer to the symbol beginning, nfft() samples long
+       *  \param  ref_chirp
+       *          The reference chirp used to dechirp the symbol
+       *  \param  res
+       *          The demodulation result
+       */
+      virtual void demod(const gr_complex *samples, const gr_complex *ref_chirp, demod_result &res) = 0;
+
+      /**
+       *  \brief  Spectrum of the last symbol demodulated, nfft() bins
+       */
+      virtual const gr_complex *spectrum() const = 0;
+
+      /**
+       *  \brief  Number of samples per symbol, and size of the FFT
+       */
+      virtual uint32_t nfft() const = 0;
+
+      // the scratch buffers of the kernels are aligned beyond what new guarantees
+      static void *operator new(size_t size);
+      static void operator delete(void *ptr);
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_SYMBOL_DEMOD_H */
@@ -0,0 +1,91 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <chrono>
+#include "telemetry_publisher.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    telemetry_publisher::telemetry_publisher(publish_fn publish, size_t capacity, unsigned period_ms)
+      : m_publish(publish), m_ring(capacity), m_period_ms(period_ms), m_running(false)
+    {
+        m_batch.resize(m_ring.capacity());
+    }
+
+    telemetry_publisher::~telemetry_publisher()
+    {
+        stop();
+    }
+
+    void telemetry_publisher::start()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running)
+            return;
+        m_running = true;
+        m_thread = std::thread(&telemetry_publisher::run, this);
+    }
+
+    void telemetry_publisher::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_wakeup.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+        // the records pushed by the last work calls
+        flush();
+    }
+
+    void telemetry_publisher::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_running) {
+            m_wakeup.wait_for(lock, std::chrono::milliseconds(m_period_ms));
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    void telemetry_publisher::flush()
+    {
+        size_t n = m_ring.pop(&m_batch[0], m_batch.size());
+        if (!n)
+            return;
+
+        pmt::pmt_t meta = pmt::make_dict();
+        meta = pmt::dict_add(meta, pmt::intern("records"), pmt::from_long(n));
+        meta = pmt::dict_add(meta, pmt::intern("record_size"), pmt::from_long(sizeof(sync_telemetry)));
+        meta = pmt::dict_add(meta, pmt::intern("dropped"), pmt::from_uint64(m_ring.dropped()));
+        pmt::pmt_t records = pmt::init_u8vector(n * sizeof(sync_telemetry),
+                                                reinterpret_cast<const uint8_t *>(&m_batch[0]));
+        m_publish(pmt::cons(meta, records));
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
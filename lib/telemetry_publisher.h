@@ -0,0 +1,94 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_TELEMETRY_PUBLISHER_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_TELEMETRY_PUBLISHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pmt/pmt.h>
+#include <CounterClockwiseAlarms/sync_telemetry.h>
+#include "spsc_ring.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Carries sync_telemetry records from a work function to a message port.
+     *
+     *  The work function pushes the records into ring(), which never blocks. A thread of the
+     *  publisher wakes up every period, takes what the ring holds and hands it, as one PDU,
+     *  to the publish function, so building the messages stays off the DSP thread.
+     */
+    class telemetry_publisher
+    {
+     public:
+      typedef std::function<void(pmt::pmt_t)> publish_fn;
+
+      /**
+       *  \param  publish
+       *          Called from the publisher thread with each batch, usually message_port_pub
+       *  \param  capacity
+       *          The number of records the ring can hold
+       *  \param  period_ms
+       *          The time between two batches, in milliseconds
+       */
+      telemetry_publisher(publish_fn publish, size_t capacity = 1024, unsigned period_ms = 100);
+      ~telemetry_publisher();
+
+      spsc_ring<sync_telemetry> &ring() { return m_ring; }
+
+      /**
+       *  \brief  Start the publisher thread, from the block start()
+       */
+      void start();
+
+      /**
+       *  \brief  Publish what is left in the ring and stop the thread, from the block stop()
+       */
+      void stop();
+
+     private:
+      publish_fn m_publish;                 ///< where the batches go
+      spsc_ring<sync_telemetry> m_ring;     ///< records waiting to be published
+      std::vector<sync_telemetry> m_batch;  ///< records of the batch being published
+      unsigned m_period_ms;                 ///< time between two batches
+
+      std::thread m_thread;                 ///< the publisher thread
+      std::mutex m_mutex;                   ///< protects m_running for m_wakeup
+      std::condition_variable m_wakeup;     ///< wakes the thread up early when stopping
+      bool m_running;                       ///< cleared to stop the thread
+
+      void run();
+
+      /**
+       *  \brief  Publish the records in the ring, if any
+       */
+      void flush();
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_TELEMETRY_PUBLISHER_H */
@@ -0,0 +1,97 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "waveform_cache.h"
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    waveform_cache &waveform_cache::instance()
+    {
+        static waveform_cache cache;
+        return cache;
+    }
+
+    // about a thousand SF9 frames without oversampling
+    waveform_cache::waveform_cache()
+      : m_budget(64 << 20), m_size(0)
+    {
+    }
+
+    waveform_cache::waveform waveform_cache::get(const waveform_key &key, const std::function<void(std::vector<gr_complex> &)> &build)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::map<waveform_key, entry>::iterator it = m_frames.find(key);
+            if (it != m_frames.end()) {
+                m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+                return it->second.wave;
+            }
+        }
+
+        std::shared_ptr<std::vector<gr_complex> > wave = std::make_shared<std::vector<gr_complex> >();
+        build(*wave);
+        size_t bytes = wave->size() * sizeof(gr_complex);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // another thread may have built the same frame meanwhile
+        std::map<waveform_key, entry>::iterator it = m_frames.find(key);
+        if (it != m_frames.end())
+            return it->second.wave;
+        if (bytes > m_budget)
+            return wave;
+        make_room(bytes);
+        m_lru.push_front(key);
+        entry &e = m_frames[key];
+        e.wave = wave;
+        e.lru = m_lru.begin();
+        m_size += bytes;
+        return wave;
+    }
+
+    void waveform_cache::set_budget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budget = bytes;
+        make_room(0);
+    }
+
+    size_t waveform_cache::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_size;
+    }
+
+    void waveform_cache::make_room(size_t bytes)
+    {
+        while (!m_lru.empty() && m_size + bytes > m_budget) {
+            std::map<waveform_key, entry>::iterator it = m_frames.find(m_lru.back());
+            m_size -= it->second.wave->size() * sizeof(gr_complex);
+            m_frames.erase(it);
+            m_lru.pop_back();
+        }
+    }
+
+  } /* namespace CounterClockwiseAlarms */
+} /* namespace gr */
@@ -0,0 +1,106 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2023 zjhao.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_COUNTERCLOCKWISEALARMS_WAVEFORM_CACHE_H
+#define INCLUDED_COUNTERCLOCKWISEALARMS_WAVEFORM_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include <CounterClockwiseAlarms/dsp_complex.h>
+
+namespace gr {
+  namespace CounterClockwiseAlarms {
+
+    /**
+     *  \brief  Everything a modulated frame depends on: sf, samp_rate, bw, the 2 sync words,
+     *          the inter-frame padding in symbols and the payload symbols.
+     */
+    typedef std::tuple<uint8_t, uint32_t, uint32_t, uint16_t, uint16_t, int, std::vector<uint8_t> > waveform_key;
+
+    /**
+     *  \brief  Process-wide LRU cache of modulated frames, within a memory budget.
+     *
+     *  Frames are built on first request, by the caller, and handed out as shared read-only
+     *  buffers: a frame evicted while a block still outputs it stays valid until the block
+     *  drops it. The least recently used frames are evicted to make room for new ones, and a
+     *  frame larger than the whole budget is returned without being cached. A budget of 0
+     *  disables the cache.
+     */
+    class waveform_cache
+    {
+     public:
+      typedef std::shared_ptr<const std::vector<gr_complex> > waveform;
+
+      static waveform_cache &instance();
+
+      /**
+       *  \brief  Return the frame of key, building it with build if it is not cached.
+       *
+       *  \param  key
+       *          The frame parameters
+       *  \param  build
+       *          Writes the frame in the vector it gets, called without the cache lock
+       */
+      waveform get(const waveform_key &key, const std::function<void(std::vector<gr_complex> &)> &build);
+
+      /**
+       *  \brief  Set the memory budget in bytes, evicting frames to fit in it
+       */
+      void set_budget(size_t bytes);
+
+      /**
+       *  \brief  Number of bytes of the frames cached
+       */
+      size_t size() const;
+
+     private:
+      struct entry
+      {
+        waveform wave;                              ///< the frame
+        std::list<waveform_key>::iterator lru;      ///< position of the key in m_lru
+      };
+
+      waveform_cache();
+      waveform_cache(const waveform_cache &);
+      waveform_cache &operator=(const waveform_cache &);
+
+      /**
+       *  \brief  Evict the least recently used frames until bytes more fit in the budget
+       */
+      void make_room(size_t bytes);
+
+      mutable std::mutex m_mutex;                   ///< protects the members below
+      size_t m_budget;                              ///< memory budget, in bytes
+      size_t m_size;                                ///< memory used by the frames cached, in bytes
+      std::map<waveform_key, entry> m_frames;       ///< the frames cached
+      std::list<waveform_key> m_lru;                ///< keys of the frames cached, most recently used first
+    };
+
+  } // namespace CounterClockwiseAlarms
+} // namespace gr
+
+#endif /* INCLUDED_COUNTERCLOCKWISEALARMS_WAVEFORM_CACHE_H */
@@ -8,14 +8,19 @@
 %include "CounterClockwiseAlarms_swig_doc.i"
 
 %{
+#include "CounterClockwiseAlarms/sample_format.h"
 #include "CounterClockwiseAlarms/mesCreater.h"
 #include "CounterClockwiseAlarms/crcAppend.h"
 #include "CounterClockwiseAlarms/DownModulate.h"
 #include "CounterClockwiseAlarms/ReceiveDown.h"
 #include "CounterClockwiseAlarms/Crc_verif.h"
 #include "CounterClockwiseAlarms/FrameSync.h"
+#include "CounterClockwiseAlarms/MultiSfSync.h"
+#include "CounterClockwiseAlarms/AlarmReceiver.h"
+#include "CounterClockwiseAlarms/AlarmTransmitter.h"
 %}
 
+%include "CounterClockwiseAlarms/sample_format.h"
 %include "CounterClockwiseAlarms/mesCreater.h"
 GR_SWIG_BLOCK_MAGIC2(CounterClockwiseAlarms, mesCreater);
 %include "CounterClockwiseAlarms/crcAppend.h"
@@ -28,3 +33,9 @@ GR_SWIG_BLOCK_MAGIC2(CounterClockwiseAlarms, ReceiveDown);
 GR_SWIG_BLOCK_MAGIC2(CounterClockwiseAlarms, Crc_verif);
 %include "CounterClockwiseAlarms/FrameSync.h"
 GR_SWIG_BLOCK_MAGIC2(CounterClockwiseAlarms, FrameSync);
+%include "CounterClockwiseAlarms/MultiSfSync.h"
+GR_SWIG_BLOCK_MAGIC2(CounterClockwiseAlarms, MultiSfSync);
+%include "CounterClockwiseAlarms/AlarmReceiver.h"
+GR_SWIG_BLOCK_MAGIC2(CounterClockwiseAlarms, AlarmReceiver);
+%include "CounterClockwiseAlarms/AlarmTransmitter.h"
+GR_SWIG_BLOCK_MAGIC2(CounterClockwiseAlarms, AlarmTransmitter);